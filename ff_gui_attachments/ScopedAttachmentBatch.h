@@ -0,0 +1,113 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ScopedAttachmentBatch.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/**
+ \class ScopedAttachmentBatch
+ \brief Collects the updates of all attachments while many properties are changed
+
+ While a ScopedAttachmentBatch is alive, the attachments of the given tree and
+ its descendants don't react to changes of their properties. They are only marked
+ and each affected component is updated once, when the batch goes out of scope.
+ If an UndoManager is supplied, all changes made inside the batch form one undo
+ transaction. If the ValueTreeAttachmentFrameDriver has a frame budget, the
+ updates are handed to it instead and spread over the following frames.
+
+ \code{.cpp}
+    {
+        ScopedAttachmentBatch batch (tree, &undoManager, "Load preset");
+        for (auto& parameter : preset)
+            tree.setProperty (parameter.id, parameter.value, &undoManager);
+    }   // every attachment is updated once here
+ \endcode
+
+ The attachments share one router in the whole process. A batch created without
+ a tree therefore holds back the updates of every tree, e.g. of all instances of
+ a plugin, until it ends.
+ */
+class ScopedAttachmentBatch
+{
+public:
+    /** Collects the updates of \param treeToBatch and its descendants */
+    explicit ScopedAttachmentBatch (const juce::ValueTree& treeToBatch,
+                                    juce::UndoManager* undoManagerToUse = nullptr,
+                                    const juce::String& transactionName = juce::String())
+      : root (treeToBatch),
+        undoMgr (undoManagerToUse)
+    {
+        // use the constructor without tree to batch all trees
+        jassert (root.isValid());
+        if (undoMgr != nullptr) {
+            undoMgr->beginNewTransaction (transactionName);
+        }
+        router->beginBatch (root);
+    }
+
+    /** Collects the updates of all trees in the process */
+    explicit ScopedAttachmentBatch (juce::UndoManager* undoManagerToUse = nullptr,
+                                    const juce::String& transactionName = juce::String())
+      : undoMgr (undoManagerToUse)
+    {
+        if (undoMgr != nullptr) {
+            undoMgr->beginNewTransaction (transactionName);
+        }
+        router->beginBatch();
+    }
+
+    ~ScopedAttachmentBatch ()
+    {
+        router->endBatch (root);
+        if (undoMgr != nullptr) {
+            undoMgr->beginNewTransaction();
+        }
+    }
+
+private:
+    juce::SharedResourcePointer<ValueTreeAttachmentRouter> router;
+    juce::ValueTree                                        root;
+    juce::UndoManager*                                     undoMgr = nullptr;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedAttachmentBatch)
+};
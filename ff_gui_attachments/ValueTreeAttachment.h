@@ -0,0 +1,415 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachment.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <memory>
+#include <type_traits>
+
+/**
+ \class ValueTreeAttachment
+ \brief The common core of the attachments binding one component to one property
+
+ The ValueTreeAttachment registers with the router, suppresses echoes, coalesces
+ updates per frame and publishes to a ValueTreeParameterBlock. What differs per
+ component is supplied by the Traits at compile time:
+
+ \code{.cpp}
+    struct MyTraits
+    {
+        using ValueType = double;   // the type the component works with
+        static ValueType getValue (const MyComponent&);
+        static void setValue (MyComponent&, const ValueType&, juce::NotificationType);
+        static constexpr juce::NotificationType initialNotification = juce::dontSendNotification;
+        static constexpr juce::NotificationType updateNotification  = juce::sendNotificationAsync;
+    };
+ \endcode
+
+ The values are converted from and to juce::var only at the tree, and compared as
+ ValueType. A subclass listens to the component and calls writeToTree() on
+ changes, see ValueTreeSliderAttachment, ValueTreeButtonAttachment,
+ ValueTreeLabelAttachment and ValueTreeComboBoxIndexAttachment.
+
+ With setSkipUpdatesWhenHidden() an attachment of a component, that is not
+ showing, e.g. on a hidden tab, only marks itself stale. It resyncs once, when
+ the component or one of its parents becomes visible again, see
+ ValueTreeAttachmentVisibilityWatcher. A ValueTreeParameterBlock is still
+ updated while the component is hidden. If the ValueTreeAttachmentFrameDriver has
+ a frame budget, the changes of a batch are shown within that budget as well.
+
+ A plain binding only holds its node, property, component and echo guard, and one
+ pointer to the shared ValueTreeAttachmentContext. The state of coalescing,
+ skipping updates while hidden and publishing to a parameter block lives in a
+ side object, that is allocated the first time one of them is switched on.
+ */
+template<typename ComponentType, typename Traits>
+class ValueTreeAttachment : public ValueTreeAttachmentRouter::Target,
+                            private ValueTreeAttachmentStats::Binding
+{
+public:
+    using ValueType = typename Traits::ValueType;
+
+    ValueTreeAttachment (juce::ValueTree& attachToTree,
+                         ComponentType* componentToAttach,
+                         juce::Identifier valueProperty,
+                         juce::UndoManager* undoManagerToUse = nullptr)
+    :   ValueTreeAttachmentStats::Binding (valueProperty, componentToAttach),
+        tree      (attachToTree),
+        component (componentToAttach),
+        property  (std::move (valueProperty)),
+        undoMgr   (undoManagerToUse)
+    {
+        // Don't attach an invalid valuetree!
+        jassert (tree.isValid());
+        jassert (componentToAttach != nullptr);
+
+        if (tree.hasProperty (property)) {
+            updateComponent (Traits::initialNotification);
+        }
+        else {
+            writeToTree();
+        }
+        getRouter().addPropertyTarget (tree, property, this);
+    }
+
+    ~ValueTreeAttachment () override
+    {
+        if (options != nullptr) {
+            context->visibilityWatcher->unwatch (options.get());
+            context->frameDriver->cancel (options.get());
+        }
+        getRouter().removePropertyTarget (tree, property, this);
+    }
+
+    /** Updates the component to reflect the ValueTree's property */
+    void routedPropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &changedProperty) override
+    {
+        const ValueTreeAttachmentStats::ScopedTimer timer (getBindingStats(), ValueTreeAttachmentStats::treeToComponent);
+        if (options == nullptr) {
+            updateComponent (Traits::updateNotification);
+        }
+        else if (isHiddenAndLazy()) {
+            options->stale = true;
+            publishTreeValue();
+        }
+        else if (options->coalesceUpdates) {
+            // the component may wait several frames, the audio thread must not
+            publishTreeValue();
+            context->frameDriver->markDirty (options.get());
+        }
+        else {
+            updateComponent (Traits::updateNotification);
+        }
+    }
+
+    /**
+     With a frame budget set, the update at the end of a batch, e.g. of a loaded
+     preset, is left to the frame driver, which updates the control under the
+     mouse first and spreads the rest over the next frames.
+     */
+    void routedBatchedPropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &changedProperty) override
+    {
+        if (changedProperty != property || ! context->frameDriver->hasFrameBudget()) {
+            routedPropertyChanged (treeWhosePropertyHasChanged, changedProperty);
+            return;
+        }
+        const ValueTreeAttachmentStats::ScopedTimer timer (getBindingStats(), ValueTreeAttachmentStats::treeToComponent);
+        if (isHiddenAndLazy()) {
+            options->stale = true;
+        }
+        else {
+            context->frameDriver->markDirty (&getOptions());
+        }
+        publishTreeValue();
+    }
+
+    /**
+     If coalescing is enabled, changes of the property are collected and the component
+     is updated only once per frame with the latest value, see ValueTreeAttachmentFrameDriver.
+     Use this for properties written at a high rate, e.g. by automation or modulation.
+     */
+    void setCoalescedUpdates (bool shouldCoalesce)
+    {
+        if (shouldCoalesce) {
+            getOptions().coalesceUpdates = true;
+        }
+        else if (options != nullptr) {
+            options->coalesceUpdates = false;
+            context->frameDriver->cancel (options.get());
+            updateComponent (Traits::updateNotification);
+        }
+    }
+
+    /** The control under the mouse or with focus is updated first, then the visible ones */
+    int getUpdatePriority () const
+    {
+        if (! component) {
+            return 0;
+        }
+        if (component->isMouseOverOrDragging (true) || component->hasKeyboardFocus (true)) {
+            return 2;
+        }
+        return component->isShowing() ? 1 : 0;
+    }
+
+    /**
+     If set, changes of the tree are not shown while the component is not showing.
+     The component is updated once, when it or one of its parents becomes visible.
+     */
+    void setSkipUpdatesWhenHidden (bool shouldSkip)
+    {
+        if (shouldSkip) {
+            auto& opts = getOptions();
+            opts.skipWhenHidden = true;
+            if (component) {
+                context->visibilityWatcher->watch (*component, &opts);
+            }
+        }
+        else if (options != nullptr) {
+            options->skipWhenHidden = false;
+            context->visibilityWatcher->unwatch (options.get());
+            resyncIfStale();
+        }
+    }
+
+    /** Returns true, if the component missed updates while it was hidden */
+    bool isStale () const
+    {
+        return options != nullptr && options->stale;
+    }
+
+    /**
+     Publishes the value into the slot \param slotIndex of \param block each time
+     the component and the tree are synced, so the audio thread can read it lock free.
+     Pass nullptr to stop publishing. Only available for numeric values.
+     */
+    void setParameterBlock (ValueTreeParameterBlock* block, int slotIndex)
+    {
+        static_assert (std::is_arithmetic<ValueType>::value, "Only numeric values can be published");
+        if (block == nullptr && options == nullptr) {
+            return;
+        }
+        auto& opts = getOptions();
+        opts.parameterBlock = block;
+        opts.parameterSlot  = slotIndex;
+        if (component) {
+            publishValue (Traits::getValue (*component));
+        }
+    }
+
+protected:
+    /** Writes the component's value to the tree, unless it is the echo of an update */
+    void writeToTree ()
+    {
+        if (component) {
+            writeToTree (Traits::getValue (*component));
+        }
+    }
+
+    /** Writes a value to the tree, e.g. after it was constrained by a subclass */
+    void writeToTree (const ValueType& value)
+    {
+        const ValueTreeAttachmentStats::ScopedTimer timer (getBindingStats(), ValueTreeAttachmentStats::componentToTree);
+        if (sync.shouldWriteToTree (value)) {
+            getBindingStats().count (ValueTreeAttachmentStats::componentToTreeWrites);
+            const typename ValueTreeAttachmentTypedSync<ValueType>::ScopedUpdate scope (sync);
+            tree.setProperty (property, toVar (value), undoMgr);
+            publishValue (value);
+        }
+        else {
+            getBindingStats().count (sync.isUpdating() ? ValueTreeAttachmentStats::suppressedEchoes
+                                                  : ValueTreeAttachmentStats::unchangedWrites);
+        }
+    }
+
+    /** Updates the component from the tree, unless it is the echo of a write */
+    void updateComponent (juce::NotificationType notification)
+    {
+        if (! component) {
+            return;
+        }
+        const ValueType value = fromVar (tree.getProperty (property));
+        if (! sync.shouldUpdateComponent (value)) {
+            getBindingStats().count (ValueTreeAttachmentStats::suppressedEchoes);
+        }
+        else {
+            getBindingStats().count (ValueTreeAttachmentStats::treeToComponentUpdates);
+            const typename ValueTreeAttachmentTypedSync<ValueType>::ScopedUpdate scope (sync);
+            Traits::setValue (*component, value, notification);
+            // the component may have clamped or snapped the value
+            const ValueType shownValue = Traits::getValue (*component);
+            sync.componentUpdated (shownValue);
+            publishValue (shownValue);
+        }
+    }
+
+    /** Forgets the synced value and updates the component, e.g. after its range changed */
+    void resyncComponent ()
+    {
+        sync.reset();
+        updateComponent (Traits::updateNotification);
+    }
+
+    ValueTreeAttachmentRouter& getRouter () const
+    {
+        return *context->router;
+    }
+
+    juce::ValueTree                             tree;
+    juce::Component::SafePointer<ComponentType> component;
+    juce::Identifier                            property;
+    juce::UndoManager*                          undoMgr = nullptr;
+
+private:
+    /**
+     The state of the features an attachment has to switch on. It is the client of
+     the frame driver and the visibility watcher, so a plain binding carries neither.
+     */
+    struct Options : public ValueTreeAttachmentFrameDriver::Client,
+                     public ValueTreeAttachmentVisibilityWatcher::Client
+    {
+        explicit Options (ValueTreeAttachment& ownerToUse) : owner (ownerToUse) {}
+
+        void flushPendingUpdate () override
+        {
+            owner.flushDeferredUpdate();
+        }
+
+        int getUpdatePriority () const override
+        {
+            return owner.getUpdatePriority();
+        }
+
+        void watchedVisibilityChanged () override
+        {
+            owner.resyncIfStale();
+        }
+
+        ValueTreeAttachment&     owner;
+        ValueTreeParameterBlock* parameterBlock  = nullptr;
+        int                      parameterSlot   = -1;
+        bool                     coalesceUpdates = false;
+        bool                     skipWhenHidden  = false;
+        bool                     stale           = false;
+
+        JUCE_DECLARE_NON_COPYABLE (Options)
+    };
+
+    Options& getOptions ()
+    {
+        if (options == nullptr) {
+            options = std::make_unique<Options> (*this);
+        }
+        return *options;
+    }
+
+    static ValueType fromVar (const juce::var& value)
+    {
+        if constexpr (std::is_same<ValueType, bool>::value) {
+            return static_cast<bool> (value);
+        }
+        else if constexpr (std::is_arithmetic<ValueType>::value) {
+            return static_cast<ValueType> (static_cast<double> (value));
+        }
+        else {
+            return value.toString();
+        }
+    }
+
+    static juce::var toVar (const ValueType& value)
+    {
+        return juce::var (value);
+    }
+
+    /** The frame driver flushes a coalesced update */
+    void flushDeferredUpdate ()
+    {
+        const ValueTreeAttachmentStats::ScopedTimer timer (getBindingStats(), ValueTreeAttachmentStats::treeToComponent);
+        if (isHiddenAndLazy()) {
+            options->stale = true;
+            publishTreeValue();
+        }
+        else {
+            updateComponent (Traits::updateNotification);
+        }
+    }
+
+    bool isHiddenAndLazy () const
+    {
+        return options != nullptr && options->skipWhenHidden && component && ! component->isShowing();
+    }
+
+    void resyncIfStale ()
+    {
+        if (isStale() && ! isHiddenAndLazy()) {
+            options->stale = false;
+            updateComponent (Traits::updateNotification);
+        }
+    }
+
+    /** Keeps the ParameterBlock in sync with the tree, while the component isn't updated */
+    void publishTreeValue ()
+    {
+        if constexpr (std::is_arithmetic<ValueType>::value) {
+            if (options != nullptr && options->parameterBlock != nullptr) {
+                publishValue (fromVar (tree.getProperty (property)));
+            }
+        }
+    }
+
+    void publishValue (const ValueType& value)
+    {
+        if constexpr (std::is_arithmetic<ValueType>::value) {
+            if (options != nullptr && options->parameterBlock != nullptr && options->parameterSlot >= 0) {
+                options->parameterBlock->set (options->parameterSlot, static_cast<float> (value));
+            }
+        }
+    }
+
+    juce::SharedResourcePointer<ValueTreeAttachmentContext> context;
+    ValueTreeAttachmentTypedSync<ValueType>                 sync;
+    std::unique_ptr<Options>                                options;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeAttachment)
+};
@@ -0,0 +1,227 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentBinder.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <unordered_map>
+
+/**
+ \class ValueTreeAttachmentBinder
+ \brief Creates the attachments of a whole component hierarchy at once
+
+ The binder indexes the properties of a ValueTree node and its descendants by
+ name once. Then it walks a component hierarchy and binds every Slider, Button,
+ ComboBox and Label whose componentID names one of those properties. The
+ attachments are created in a ValueTreeAttachmentSet inside a
+ ScopedAttachmentBatch, so no attachment is notified while the others are set
+ up. As the router finds the nodes in a hash map as well, opening an editor
+ takes linear time in the number of controls.
+
+ If a property exists in several nodes, the one closest to the root is used.
+ A control whose property doesn't exist yet creates it in the root node with
+ its current value, unless that is switched off, then its componentID is
+ reported by getUnboundComponentIDs().
+
+ \code{.cpp}
+    binder = std::make_unique<ValueTreeAttachmentBinder> (state, &undoManager);
+    binder->bindComponents (*this);
+ \endcode
+ */
+class ValueTreeAttachmentBinder
+{
+public:
+    /**
+     Creates a binder for the properties of \param treeToBind. If \param searchChildNodes
+     is set, the properties of all descendants are bound as well.
+     */
+    ValueTreeAttachmentBinder (juce::ValueTree& treeToBind,
+                               juce::UndoManager* undoManagerToUse = nullptr,
+                               bool searchChildNodes = true)
+    :   tree (treeToBind),
+        undoMgr (undoManagerToUse)
+    {
+        // Don't attach an invalid valuetree!
+        jassert (tree.isValid());
+        indexProperties (tree, searchChildNodes);
+    }
+
+    ~ValueTreeAttachmentBinder ()
+    {
+        unbindAll();
+    }
+
+    /**
+     Binds all components in the hierarchy of \param root including root itself.
+     Components without componentID are skipped. If \param createMissingProperties
+     is set, a missing property is created in the root node from the control's
+     value, otherwise the control is skipped and reported.
+     Returns the number of created attachments.
+     */
+    int bindComponents (juce::Component& root, bool createMissingProperties = true)
+    {
+        const int numBefore = attachments.getNumAttachments();
+        createMissing = createMissingProperties;
+        unboundComponentIDs.clear();
+        {
+            const ScopedAttachmentBatch batch (tree);
+            bindComponent (root);
+        }
+        return attachments.getNumAttachments() - numBefore;
+    }
+
+    /** Detaches and destroys all attachments created by this binder */
+    void unbindAll ()
+    {
+        const ScopedAttachmentBatch batch (tree);
+        attachments.clear();
+    }
+
+    int getNumBindings () const
+    {
+        return attachments.getNumAttachments();
+    }
+
+    /** Returns the componentIDs of the controls the last bindComponents() skipped, because their property didn't exist */
+    const juce::StringArray& getUnboundComponentIDs () const
+    {
+        return unboundComponentIDs;
+    }
+
+    /** Returns the set owning the attachments, e.g. to report its memory footprint */
+    const ValueTreeAttachmentSet& getAttachments () const
+    {
+        return attachments;
+    }
+
+private:
+    struct StringHash
+    {
+        size_t operator() (const juce::String& s) const noexcept
+        {
+            return static_cast<size_t> (s.hashCode64());
+        }
+    };
+
+    struct IndexedProperty
+    {
+        juce::ValueTree  node;
+        juce::Identifier property;
+    };
+
+    /** Indexes breadth first, so the first node having a property wins */
+    void indexProperties (const juce::ValueTree& root, bool searchChildNodes)
+    {
+        juce::Array<juce::ValueTree> queue;
+        queue.add (root);
+        for (int n=0; n < queue.size(); ++n) {
+            const juce::ValueTree node = queue.getUnchecked (n);
+            for (int i=0; i < node.getNumProperties(); ++i) {
+                const juce::Identifier name = node.getPropertyName (i);
+                index.emplace (name.toString(), IndexedProperty { node, name });
+            }
+            if (searchChildNodes) {
+                for (int i=0; i < node.getNumChildren(); ++i) {
+                    queue.add (node.getChild (i));
+                }
+            }
+        }
+    }
+
+    void bindComponent (juce::Component& component)
+    {
+        const juce::String& componentID = component.getComponentID();
+        if (componentID.isNotEmpty()) {
+            auto entry = index.find (componentID);
+            if (entry != index.end()) {
+                bindTo (component, entry->second);
+            }
+            else if (isBindable (component)) {
+                if (createMissing) {
+                    // the attachment writes the control's value into the new property
+                    entry = index.emplace (componentID, IndexedProperty { tree, componentID }).first;
+                    bindTo (component, entry->second);
+                }
+                else {
+                    unboundComponentIDs.addIfNotAlreadyThere (componentID);
+                }
+            }
+        }
+        for (int i=0; i < component.getNumChildComponents(); ++i) {
+            bindComponent (*component.getChildComponent (i));
+        }
+    }
+
+    static bool isBindable (juce::Component& component)
+    {
+        return dynamic_cast<juce::Slider*> (&component) != nullptr
+            || dynamic_cast<juce::Button*> (&component) != nullptr
+            || dynamic_cast<juce::ComboBox*> (&component) != nullptr
+            || dynamic_cast<juce::Label*> (&component) != nullptr;
+    }
+
+    void bindTo (juce::Component& component, IndexedProperty& target)
+    {
+        if (auto* slider = dynamic_cast<juce::Slider*> (&component)) {
+            attachments.add<ValueTreeSliderAttachment> (target.node, target.property, *slider, undoMgr);
+        }
+        else if (auto* button = dynamic_cast<juce::Button*> (&component)) {
+            attachments.add<ValueTreeButtonAttachment> (target.node, button, target.property, undoMgr);
+        }
+        else if (auto* comboBox = dynamic_cast<juce::ComboBox*> (&component)) {
+            attachments.add<ValueTreeComboBoxIndexAttachment> (target.node, comboBox, target.property, undoMgr);
+        }
+        else if (auto* label = dynamic_cast<juce::Label*> (&component)) {
+            attachments.add<ValueTreeLabelAttachment> (target.node, label, target.property, undoMgr);
+        }
+    }
+
+    juce::ValueTree                                               tree;
+    juce::UndoManager*                                            undoMgr = nullptr;
+    std::unordered_map<juce::String, IndexedProperty, StringHash> index;
+    ValueTreeAttachmentSet                                        attachments;
+    juce::StringArray                                             unboundComponentIDs;
+    bool                                                          createMissing = true;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeAttachmentBinder)
+};
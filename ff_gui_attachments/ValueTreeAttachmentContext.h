@@ -0,0 +1,65 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentContext.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+#pragma once
+
+/**
+ \class ValueTreeAttachmentContext
+ \brief The shared objects an attachment works with, held through one pointer
+
+ An attachment needs the router, and for coalesced updates and for skipping
+ updates while hidden also the frame driver and the visibility watcher. Instead
+ of a juce::SharedResourcePointer to each of them, every attachment holds one to
+ the context, which keeps the three alive as long as any attachment exists.
+ */
+class ValueTreeAttachmentContext
+{
+public:
+    ValueTreeAttachmentContext () = default;
+
+    juce::SharedResourcePointer<ValueTreeAttachmentRouter>            router;
+    juce::SharedResourcePointer<ValueTreeAttachmentFrameDriver>       frameDriver;
+    juce::SharedResourcePointer<ValueTreeAttachmentVisibilityWatcher> visibilityWatcher;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeAttachmentContext)
+};
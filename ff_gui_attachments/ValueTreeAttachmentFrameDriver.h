@@ -0,0 +1,278 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentFrameDriver.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+/**
+ \class ValueTreeAttachmentFrameDriver
+ \brief Flushes coalesced tree to GUI updates once per display frame
+
+ Attachments in coalescing mode don't update their component on every change of
+ the tree. They mark themselves dirty instead, and the driver flushes each dirty
+ attachment once per frame, so only the latest value is shown. With a property
+ written at audio or sequencer rate this limits the work to the number of frames
+ times the number of changed controls.
+
+ All attachments share one driver through a juce::SharedResourcePointer. The
+ timer only runs while there are pending updates.
+
+ With a frame budget set, each frame flushes the clients with the highest update
+ priority first, e.g. the control under the mouse, and stops when the budget is
+ used up. The remaining clients are carried over to the next frame, so the time
+ spent per frame stays bounded, no matter how many clients are dirty. While a
+ budget is set, the attachments changed by a ScopedAttachmentBatch or an applied
+ ValueTreeDiff leave their update to the driver as well, so loading a big preset
+ is spread over several frames. The ComboBox and radio group attachments are
+ still updated when the batch ends.
+ */
+class ValueTreeAttachmentFrameDriver : private juce::Timer
+{
+public:
+    /**
+     The interface an attachment implements to receive the frame callback
+     */
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        /** Called once per frame after the client was marked dirty */
+        virtual void flushPendingUpdate () = 0;
+
+        /** Clients with a higher priority are flushed first, if a frame budget is set */
+        virtual int getUpdatePriority () const
+        {
+            return 0;
+        }
+
+    private:
+        friend class ValueTreeAttachmentFrameDriver;
+        bool pendingFlush = false;
+        bool inFlushing   = false;  ///< the slot refers to flushing instead of dirty
+        int  slot         = -1;
+    };
+
+    ValueTreeAttachmentFrameDriver () = default;
+
+    ~ValueTreeAttachmentFrameDriver () override
+    {
+        stopTimer();
+    }
+
+    /** Schedules the client for the next frame. Marking it again before is a no-op. */
+    void markDirty (Client* client)
+    {
+        if (! client->pendingFlush) {
+            client->pendingFlush = true;
+            addDirty (client);
+            if (! isTimerRunning()) {
+                startTimerHz (frameRate);
+            }
+        }
+    }
+
+    /** Removes a pending client, call this before the client is destroyed */
+    void cancel (Client* client)
+    {
+        if (client->pendingFlush) {
+            client->pendingFlush = false;
+            // the slot is cleared instead of removed, so cancelling takes constant time
+            if (client->inFlushing) {
+                flushing.set (client->slot, nullptr);
+            }
+            else {
+                dirty.set (client->slot, nullptr);
+                --numDirty;
+            }
+        }
+    }
+
+    /** Sets the rate at which the pending updates are flushed, 60 by default */
+    void setFrameRate (int framesPerSecond)
+    {
+        jassert (framesPerSecond > 0);
+        frameRate = framesPerSecond;
+        if (isTimerRunning()) {
+            startTimerHz (frameRate);
+        }
+    }
+
+    int getFrameRate () const
+    {
+        return frameRate;
+    }
+
+    /**
+     Limits the time spent flushing per frame to \param milliseconds. The clients,
+     that didn't fit in, are flushed in the next frames. Set 0 to flush all at once,
+     which is the default.
+     */
+    void setFrameBudget (double milliseconds)
+    {
+        jassert (milliseconds >= 0.0);
+        frameBudgetTicks = juce::Time::secondsToHighResolutionTicks (milliseconds / 1000.0);
+    }
+
+    double getFrameBudget () const
+    {
+        return juce::Time::highResolutionTicksToSeconds (frameBudgetTicks) * 1000.0;
+    }
+
+    /** Returns true, if a frame budget is set */
+    bool hasFrameBudget () const
+    {
+        return frameBudgetTicks > 0;
+    }
+
+    /** Flushes all pending updates immediately, ignoring the frame budget */
+    void flush ()
+    {
+        flushClients (false);
+    }
+
+    /**
+     Flushes the pending updates within the frame budget, as the timer does. Call
+     this e.g. from a juce::VBlankAttachment to flush in sync with the display.
+     */
+    void flushFrame ()
+    {
+        flushClients (hasFrameBudget());
+    }
+
+    /** Returns the number of clients waiting for the next frame */
+    int getNumPendingClients () const
+    {
+        return numDirty;
+    }
+
+private:
+    void timerCallback () override
+    {
+        flushFrame();
+    }
+
+    void flushClients (bool limitToBudget)
+    {
+        // the sorting is part of the frame's work, so the deadline is taken first
+        const juce::int64 deadline = juce::Time::getHighResolutionTicks() + frameBudgetTicks;
+
+        // clients marked dirty while flushing will be served in the next frame
+        flushing.swapWith (dirty);
+        numDirty = 0;
+        if (limitToBudget) {
+            sortByPriority();
+        }
+        for (int i = 0; i < flushing.size(); ++i) {
+            if (auto* client = flushing.getUnchecked (i)) {
+                client->inFlushing = true;
+                client->slot       = i;
+            }
+        }
+
+        int i = 0;
+        for (; i < flushing.size(); ++i) {
+            // at least one client is flushed per frame
+            if (limitToBudget && i > 0 && juce::Time::getHighResolutionTicks() >= deadline) {
+                break;
+            }
+            if (auto* client = flushing.getUnchecked (i)) {
+                client->pendingFlush = false;
+                client->inFlushing   = false;
+                flushing.set (i, nullptr);
+                client->flushPendingUpdate();
+            }
+        }
+        // the rest stays pending for the next frame
+        for (; i < flushing.size(); ++i) {
+            if (auto* client = flushing.getUnchecked (i)) {
+                addDirty (client);
+            }
+        }
+        flushing.clearQuick();
+
+        if (numDirty == 0) {
+            dirty.clearQuick();
+            stopTimer();
+        }
+    }
+
+    void addDirty (Client* client)
+    {
+        client->inFlushing = false;
+        client->slot       = dirty.size();
+        dirty.add (client);
+        ++numDirty;
+    }
+
+    /** Orders the clients by descending priority, keeping the order within one priority */
+    void sortByPriority ()
+    {
+        prioritised.clear();
+        prioritised.reserve (static_cast<size_t> (flushing.size()));
+        for (auto* client : flushing) {
+            if (client != nullptr) {
+                prioritised.emplace_back (client->getUpdatePriority(), client);
+            }
+        }
+        std::stable_sort (prioritised.begin(), prioritised.end(),
+                          [] (const std::pair<int, Client*>& a, const std::pair<int, Client*>& b) { return a.first > b.first; });
+        flushing.clearQuick();
+        for (auto& entry : prioritised) {
+            flushing.add (entry.second);
+        }
+    }
+
+    juce::Array<Client*>                 dirty;
+    juce::Array<Client*>                 flushing;
+    std::vector<std::pair<int, Client*>> prioritised;
+    int                                  numDirty         = 0;
+    juce::int64                          frameBudgetTicks = 0;
+    int                                  frameRate        = 60;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeAttachmentFrameDriver)
+};
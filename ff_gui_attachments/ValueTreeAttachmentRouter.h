@@ -0,0 +1,861 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentRouter.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ \class ValueTreeAttachmentRouter
+ \brief Dispatches ValueTree callbacks to the attachments bound to a node and property
+
+ Instead of every attachment registering itself as ValueTree::Listener, the router
+ registers one listener per node and looks the receivers up in a hash index keyed
+ by the property. A change of a property only reaches the attachments bound to
+ exactly that node and property, no matter how many attachments share the node.
+
+ All attachments share one router through a juce::SharedResourcePointer. The
+ targets are added and removed on the message thread and are only called there.
+ If another thread, e.g. a preset loader, changes a property, the change is
+ queued and routed asynchronously on the message thread. Only changes that reach
+ a target are queued, and repeated changes of the same property are coalesced,
+ so a background import of thousands of values causes one update per binding.
+ Children added, removed or moved on another thread are forwarded in order, with
+ the indices adjusted to the children at the time they are routed. Note that a ValueTree itself is not thread safe,
+ the other thread must not change the tree while it is read on the message thread.
+
+ Between beginBatch() and endBatch() property changes of the given tree and its
+ descendants are only collected. Each target is called once per changed node and
+ property when the batch ends, see ScopedAttachmentBatch and
+ Target::routedBatchedPropertyChanged. Other trees, e.g. the
+ state of another plugin instance in the same process, are routed as usual. Added, removed and moved children are still routed
+ immediately, because their indices are only valid at that moment. Targets added
+ with addChildrenTarget are told when a batch starts and ends, so they can e.g.
+ rebuild a list once instead of once per added or removed child.
+
+ The router listens to its own copy of each node. Assigning another tree to the
+ juce::ValueTree variable an attachment was created with does not move the
+ attachment, create a new attachment for the new tree instead.
+ */
+class ValueTreeAttachmentRouter : private juce::AsyncUpdater
+{
+public:
+    /**
+     The interface an attachment implements to receive routed callbacks
+     */
+    class Target
+    {
+    public:
+        virtual ~Target() = default;
+
+        /** A property this target was added for has changed in node */
+        virtual void routedPropertyChanged (juce::ValueTree& node, const juce::Identifier& property) = 0;
+
+        /**
+         A property changed during a batch, called once when the batch has ended.
+         A target can defer the update from here, e.g. to the next frames.
+         */
+        virtual void routedBatchedPropertyChanged (juce::ValueTree& node, const juce::Identifier& property)
+        {
+            routedPropertyChanged (node, property);
+        }
+
+        /** A child was added to a node this target was added for with addChildrenTarget */
+        virtual void routedChildAdded (juce::ValueTree& parent, juce::ValueTree& child) {}
+
+        /** A child was removed from a node this target was added for with addChildrenTarget */
+        virtual void routedChildRemoved (juce::ValueTree& parent, juce::ValueTree& child, int index) {}
+
+        /** The children of a node this target was added for with addChildrenTarget were reordered */
+        virtual void routedChildOrderChanged (juce::ValueTree& parent, int oldIndex, int newIndex) {}
+
+        /**
+         A batch has started. Targets added with addChildrenTarget can defer expensive
+         work on structural changes until routedBatchEnded.
+         */
+        virtual void routedBatchStarted () {}
+
+        /** The batch has ended, after the collected property changes were routed */
+        virtual void routedBatchEnded () {}
+    };
+
+    /**
+     An observer is called around every callback of a target, e.g. to profile the attachments
+     */
+    class Observer
+    {
+    public:
+        virtual ~Observer() = default;
+
+        /** A target is about to be called for property in node. The property is invalid for child callbacks. */
+        virtual void targetCallbackStarted (Target* target, const juce::ValueTree& node, const juce::Identifier& property) = 0;
+
+        /** The callback has returned. The target may have been deleted in the meantime. */
+        virtual void targetCallbackFinished (Target* target) = 0;
+    };
+
+    ValueTreeAttachmentRouter () = default;
+
+    ~ValueTreeAttachmentRouter () override
+    {
+        cancelPendingUpdate();
+    }
+
+    /** Routes changes of property in node to target */
+    void addPropertyTarget (const juce::ValueTree& node, const juce::Identifier& property, Target* target)
+    {
+        auto& listener = getOrCreateNodeListener (node);
+        const juce::ScopedLock lock (offThreadLock);
+        listener.propertyTargets[property].addIfNotAlreadyThere (target);
+    }
+
+    /** Routes changes of property in any direct child of parent to target */
+    void addChildPropertyTarget (const juce::ValueTree& parent, const juce::Identifier& property, Target* target)
+    {
+        auto& listener = getOrCreateNodeListener (parent);
+        const juce::ScopedLock lock (offThreadLock);
+        listener.childPropertyTargets[property].addIfNotAlreadyThere (target);
+    }
+
+    /** Routes added, removed and reordered children of parent to target */
+    void addChildrenTarget (const juce::ValueTree& parent, Target* target)
+    {
+        auto& listener = getOrCreateNodeListener (parent);
+        const juce::ScopedLock lock (offThreadLock);
+        listener.childrenTargets.addIfNotAlreadyThere (target);
+    }
+
+    void removePropertyTarget (const juce::ValueTree& node, const juce::Identifier& property, Target* target)
+    {
+        pruneUnusedNodes();
+        cancelPendingChanges (target, property);
+        if (auto* listener = findNodeListener (node))
+        {
+            const juce::ScopedLock lock (offThreadLock);
+            listener->removeFrom (listener->propertyTargets, property, target);
+            removeIfUnused (listener);
+        }
+    }
+
+    void removeChildPropertyTarget (const juce::ValueTree& parent, const juce::Identifier& property, Target* target)
+    {
+        pruneUnusedNodes();
+        cancelPendingChanges (target, property);
+        if (auto* listener = findNodeListener (parent))
+        {
+            const juce::ScopedLock lock (offThreadLock);
+            listener->removeFrom (listener->childPropertyTargets, property, target);
+            removeIfUnused (listener);
+        }
+    }
+
+    void removeChildrenTarget (const juce::ValueTree& parent, Target* target)
+    {
+        pruneUnusedNodes();
+        std::replace (batchedTargets.begin(), batchedTargets.end(), target, static_cast<Target*> (nullptr));
+        if (endingBatchTargets != nullptr) {
+            std::replace (endingBatchTargets->begin(), endingBatchTargets->end(), target, static_cast<Target*> (nullptr));
+        }
+        if (auto* listener = findNodeListener (parent))
+        {
+            const juce::ScopedLock lock (offThreadLock);
+            removeTarget (listener->childrenTargets, target);
+            removeIfUnused (listener);
+        }
+    }
+
+    /**
+     Starts collecting the property changes of \param root and its descendants
+     instead of routing them. An invalid root collects the changes of all trees
+     in the process. Batches can be nested, the changes are delivered when the
+     outermost batch ends.
+     */
+    void beginBatch (const juce::ValueTree& root = juce::ValueTree())
+    {
+        batchRoots.add (root);
+        startBatchedTargets (root);
+    }
+
+    /** Ends the batch started with the same \param root and routes each collected change once */
+    void endBatch (const juce::ValueTree& root = juce::ValueTree())
+    {
+        jassert (batchRoots.contains (root));
+        batchRoots.removeFirstMatchingValue (root);
+        if (batchRoots.isEmpty()) {
+            flushPendingChanges();
+            endBatchedTargets();
+        }
+    }
+
+    bool isInBatch () const
+    {
+        return ! batchRoots.isEmpty();
+    }
+
+    /** Returns true, if changes of \param node are collected by a running batch */
+    bool isInBatch (const juce::ValueTree& node) const
+    {
+        for (const auto& root : batchRoots) {
+            if (! root.isValid() || root == node || node.isAChildOf (root)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /** Adds an observer called around every target callback */
+    void addObserver (Observer* observerToAdd)
+    {
+        observers.add (observerToAdd);
+    }
+
+    /** Removes an observer, call this before the observer is destroyed */
+    void removeObserver (Observer* observerToRemove)
+    {
+        observers.remove (observerToRemove);
+    }
+
+    /** Routes the changes queued by other threads now, call this on the message thread */
+    void handleOffThreadChangesNow ()
+    {
+        handleUpdateNowIfNeeded();
+    }
+
+    /** Returns the number of ValueTree::Listeners the router has registered */
+    int getNumListenedNodes () const
+    {
+        return static_cast<int> (nodes.size());
+    }
+
+private:
+    /** Identifiers are pooled, so the address of the name is unique and cheap to hash */
+    struct IdentifierHash
+    {
+        size_t operator() (const juce::Identifier& identifier) const noexcept
+        {
+            return std::hash<const void*>() (identifier.getCharPointer().getAddress());
+        }
+    };
+
+    using TargetMap = std::unordered_map<juce::Identifier, juce::Array<Target*>, IdentifierHash>;
+
+    /**
+     The one ValueTree::Listener registered per node
+     */
+    class NodeListener : public juce::ValueTree::Listener
+    {
+    public:
+        NodeListener (ValueTreeAttachmentRouter& ownerToUse, const juce::ValueTree& nodeToListenTo)
+          : owner (ownerToUse),
+            node (nodeToListenTo)
+        {
+            node.addListener (this);
+        }
+
+        ~NodeListener () override
+        {
+            node.removeListener (this);
+        }
+
+        void valueTreePropertyChanged (juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& changedProperty) override
+        {
+            if (! isMessageThread()) {
+                owner.queueOffThreadChange (*this, OffThreadChange (OffThreadChange::propertyChanged, node, treeWhosePropertyHasChanged,
+                                                                    {}, changedProperty));
+                return;
+            }
+            // the listener also gets called for every node below, so the node check comes first
+            if (treeWhosePropertyHasChanged == node) {
+                routeProperty (propertyTargets, treeWhosePropertyHasChanged, changedProperty);
+            }
+            else if (! childPropertyTargets.empty() && treeWhosePropertyHasChanged.getParent() == node) {
+                routeProperty (childPropertyTargets, treeWhosePropertyHasChanged, changedProperty);
+            }
+        }
+
+        void valueTreeChildAdded (juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenAdded) override
+        {
+            if (! isMessageThread()) {
+                owner.queueOffThreadChange (*this, OffThreadChange (OffThreadChange::childAdded, node, parentTree,
+                                                                    childWhichHasBeenAdded));
+                return;
+            }
+            if (parentTree == node) {
+                dispatch (childrenTargets, parentTree, juce::Identifier(), [&] (Target& target) {
+                    target.routedChildAdded (parentTree, childWhichHasBeenAdded);
+                });
+            }
+        }
+
+        void valueTreeChildRemoved (juce::ValueTree& parentTree, juce::ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override
+        {
+            if (! isMessageThread()) {
+                owner.queueOffThreadChange (*this, OffThreadChange (OffThreadChange::childRemoved, node, parentTree,
+                                                                    childWhichHasBeenRemoved, {}, indexFromWhichChildWasRemoved));
+                return;
+            }
+            if (parentTree == node) {
+                dispatch (childrenTargets, parentTree, juce::Identifier(), [&] (Target& target) {
+                    target.routedChildRemoved (parentTree, childWhichHasBeenRemoved, indexFromWhichChildWasRemoved);
+                });
+            }
+        }
+
+        void valueTreeChildOrderChanged (juce::ValueTree& parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override
+        {
+            if (! isMessageThread()) {
+                // the moved child is kept to find its index again, when the change is routed
+                owner.queueOffThreadChange (*this, OffThreadChange (OffThreadChange::childOrderChanged, node, parentTreeWhoseChildrenHaveMoved,
+                                                                    parentTreeWhoseChildrenHaveMoved.getChild (newIndex), {}, oldIndex, newIndex));
+                return;
+            }
+            if (parentTreeWhoseChildrenHaveMoved == node) {
+                dispatch (childrenTargets, parentTreeWhoseChildrenHaveMoved, juce::Identifier(), [&] (Target& target) {
+                    target.routedChildOrderChanged (parentTreeWhoseChildrenHaveMoved, oldIndex, newIndex);
+                });
+            }
+        }
+
+        void valueTreeParentChanged (juce::ValueTree&) override {}
+        void valueTreeRedirected (juce::ValueTree&) override {}
+
+        void removeFrom (TargetMap& map, const juce::Identifier& property, Target* target)
+        {
+            auto entry = map.find (property);
+            if (entry != map.end()) {
+                owner.removeTarget (entry->second, target);
+                // erasing would invalidate the array a running dispatch iterates over
+                if (entry->second.isEmpty() && owner.dispatchDepth == 0) {
+                    map.erase (entry);
+                }
+            }
+        }
+
+        bool isUnused () const
+        {
+            return childrenTargets.isEmpty() && isUnused (propertyTargets) && isUnused (childPropertyTargets);
+        }
+
+        /** Returns true, if a change of property in changedTree reaches a target */
+        bool routesProperty (const juce::ValueTree& changedTree, const juce::Identifier& property) const
+        {
+            if (changedTree == node) {
+                return hasTargets (propertyTargets, property);
+            }
+            return changedTree.getParent() == node && hasTargets (childPropertyTargets, property);
+        }
+
+        /** Returns true, if added, removed or moved children of parent reach a target */
+        bool routesChildren (const juce::ValueTree& parent) const
+        {
+            return parent == node && ! childrenTargets.isEmpty();
+        }
+
+        ValueTreeAttachmentRouter&  owner;
+        juce::ValueTree             node;
+        TargetMap                   propertyTargets;
+        TargetMap                   childPropertyTargets;
+        juce::Array<Target*>        childrenTargets;
+
+    private:
+        static bool isMessageThread ()
+        {
+            // without a MessageManager, e.g. in a command line tool, everything is routed directly
+            auto* messageManager = juce::MessageManager::getInstanceWithoutCreating();
+            return messageManager == nullptr || messageManager->isThisTheMessageThread();
+        }
+
+        void routeProperty (TargetMap& map, juce::ValueTree& changedTree, const juce::Identifier& property)
+        {
+            auto entry = map.find (property);
+            if (entry == map.end()) {
+                return;
+            }
+            if (owner.isInBatch() && owner.isInBatch (changedTree)) {
+                for (auto* target : entry->second) {
+                    owner.addPendingChange (target, changedTree, property);
+                }
+            }
+            else {
+                dispatch (entry->second, changedTree, property, [&] (Target& target) {
+                    target.routedPropertyChanged (changedTree, property);
+                });
+            }
+        }
+
+        /**
+         Iterates backwards like juce::ListenerList. Targets removed while being called
+         adjust the running iterations, so every remaining target is called exactly once.
+         */
+        template<typename Callback>
+        void dispatch (juce::Array<Target*>& targets, const juce::ValueTree& changedTree,
+                       const juce::Identifier& property, Callback&& callback)
+        {
+            Iteration iteration { &targets, targets.size(), owner.iterations };
+            owner.iterations = &iteration;
+            ++owner.dispatchDepth;
+            while (--iteration.index >= 0) {
+                if (iteration.index < targets.size()) {
+                    owner.callTarget (targets.getUnchecked (iteration.index), changedTree, property, callback);
+                }
+            }
+            --owner.dispatchDepth;
+            owner.iterations = iteration.next;
+        }
+
+        static bool hasTargets (const TargetMap& map, const juce::Identifier& property)
+        {
+            auto entry = map.find (property);
+            return entry != map.end() && ! entry->second.isEmpty();
+        }
+
+        static bool isUnused (const TargetMap& map)
+        {
+            for (auto& entry : map) {
+                if (! entry.second.isEmpty()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE (NodeListener)
+    };
+
+    /** A running dispatch over an array of targets, the running ones form a stack */
+    struct Iteration
+    {
+        juce::Array<Target*>* targets;
+        int                   index;
+        Iteration*            next;
+    };
+
+    /** Removes a target, so that running dispatches neither skip nor repeat a target */
+    void removeTarget (juce::Array<Target*>& targets, Target* target)
+    {
+        const int index = targets.indexOf (target);
+        if (index < 0) {
+            return;
+        }
+        targets.remove (index);
+        for (auto* iteration = iterations; iteration != nullptr; iteration = iteration->next) {
+            if (iteration->targets == &targets && index < iteration->index) {
+                --iteration->index;
+            }
+        }
+    }
+
+    /** All changes of one property a target has received during a batch */
+    struct PendingChange
+    {
+        Target*                     target;
+        juce::Identifier            property;
+        juce::Array<juce::ValueTree> nodes;
+    };
+
+    struct PendingKey
+    {
+        Target*     target;
+        const void* property;
+
+        bool operator== (const PendingKey& other) const noexcept
+        {
+            return target == other.target && property == other.property;
+        }
+    };
+
+    struct PendingKeyHash
+    {
+        size_t operator() (const PendingKey& key) const noexcept
+        {
+            return std::hash<const void*>() (key.target) ^ (std::hash<const void*>() (key.property) << 1);
+        }
+    };
+
+    void addPendingChange (Target* target, const juce::ValueTree& changedTree, const juce::Identifier& property)
+    {
+        const PendingKey key { target, property.getCharPointer().getAddress() };
+        auto entry = pendingIndex.find (key);
+        if (entry == pendingIndex.end()) {
+            entry = pendingIndex.emplace (key, pendingChanges.size()).first;
+            pendingChanges.push_back ({ target, property, {} });
+        }
+        pendingChanges [entry->second].nodes.addIfNotAlreadyThere (changedTree);
+    }
+
+    void cancelPendingChanges (Target* target, const juce::Identifier& property)
+    {
+        auto entry = pendingIndex.find ({ target, property.getCharPointer().getAddress() });
+        if (entry != pendingIndex.end()) {
+            pendingChanges [entry->second].target = nullptr;
+        }
+        if (flushingChanges != nullptr) {
+            for (auto& change : *flushingChanges) {
+                if (change.target == target && change.property == property) {
+                    change.target = nullptr;
+                }
+            }
+        }
+    }
+
+    void flushPendingChanges ()
+    {
+        // targets may write to the tree or start a new batch while being flushed
+        std::vector<PendingChange> changes;
+        changes.swap (pendingChanges);
+        pendingIndex.clear();
+
+        auto* outerFlushingChanges = flushingChanges;
+        flushingChanges = &changes;
+        ++dispatchDepth;
+        for (size_t i = 0; i < changes.size(); ++i) {
+            for (int n = 0; n < changes [i].nodes.size(); ++n) {
+                if (auto* target = changes [i].target) {
+                    juce::ValueTree changedTree = changes [i].nodes.getUnchecked (n);
+                    callTarget (target, changedTree, changes [i].property, [&] (Target& t) {
+                        t.routedBatchedPropertyChanged (changedTree, changes [i].property);
+                    });
+                }
+            }
+        }
+        --dispatchDepth;
+        flushingChanges = outerFlushingChanges;
+    }
+
+    /** Tells the structural targets inside root, that a batch has started */
+    void startBatchedTargets (const juce::ValueTree& root)
+    {
+        const size_t firstNew = batchedTargets.size();
+        for (auto& entry : nodes) {
+            const juce::ValueTree& node = entry.second->node;
+            if (entry.second->childrenTargets.isEmpty()
+                || (root.isValid() && root != node && ! node.isAChildOf (root))) {
+                continue;
+            }
+            for (auto* target : entry.second->childrenTargets) {
+                // a nested batch may cover targets, that were started already
+                if (std::find (batchedTargets.begin(), batchedTargets.end(), target) == batchedTargets.end()) {
+                    batchedTargets.push_back (target);
+                }
+            }
+        }
+        for (size_t i = firstNew; i < batchedTargets.size(); ++i) {
+            if (auto* target = batchedTargets [i]) {
+                target->routedBatchStarted();
+            }
+        }
+    }
+
+    /** Tells the structural targets told about the start, that the batch has ended */
+    void endBatchedTargets ()
+    {
+        // targets may start a new batch or remove other targets while being called
+        std::vector<Target*> targets;
+        targets.swap (batchedTargets);
+        auto* outerEndingTargets = endingBatchTargets;
+        endingBatchTargets = &targets;
+        ++dispatchDepth;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (auto* target = targets [i]) {
+                target->routedBatchEnded();
+            }
+        }
+        --dispatchDepth;
+        endingBatchTargets = outerEndingTargets;
+    }
+
+    /** Calls a target, wrapped by the callbacks of the observers */
+    template<typename Callback>
+    void callTarget (Target* target, const juce::ValueTree& changedTree, const juce::Identifier& property, Callback&& callback)
+    {
+        if (observers.isEmpty()) {
+            callback (*target);
+            return;
+        }
+        observers.call ([&] (Observer& o) { o.targetCallbackStarted (target, changedTree, property); });
+        callback (*target);
+        // observers removed by the callback are skipped by the ListenerList
+        observers.call ([&] (Observer& o) { o.targetCallbackFinished (target); });
+    }
+
+    /** A callback received on another thread, to be routed on the message thread */
+    struct OffThreadChange
+    {
+        enum Type
+        {
+            propertyChanged = 0,
+            childAdded,
+            childRemoved,
+            childOrderChanged
+        };
+
+        OffThreadChange (Type typeOfChange, const juce::ValueTree& listenedNode, const juce::ValueTree& changedTree,
+                         const juce::ValueTree& changedChild = juce::ValueTree(),
+                         const juce::Identifier& changedProperty = juce::Identifier(),
+                         int oldIndex = -1, int newIndexToUse = -1)
+          : type (typeOfChange),
+            node (listenedNode),
+            tree (changedTree),
+            child (changedChild),
+            property (changedProperty),
+            index (oldIndex),
+            newIndex (newIndexToUse)
+        {
+        }
+
+        Type             type;
+        juce::ValueTree  node;          ///< the node of the NodeListener, that received the change
+        juce::ValueTree  tree;
+        juce::ValueTree  child;
+        juce::Identifier property;
+        int              index    = -1;
+        int              newIndex = -1;
+    };
+
+    /** A property change is coalesced per listened node, changed node and property */
+    struct OffThreadKey
+    {
+        const void* node;
+        const void* tree;
+        const void* property;
+
+        bool operator== (const OffThreadKey& other) const noexcept
+        {
+            return node == other.node && tree == other.tree && property == other.property;
+        }
+    };
+
+    struct OffThreadKeyHash
+    {
+        size_t operator() (const OffThreadKey& key) const noexcept
+        {
+            const std::hash<const void*> hash;
+            return hash (key.node) ^ (hash (key.tree) << 1) ^ (hash (key.property) << 2);
+        }
+    };
+
+    /**
+     Queues a change, if it reaches a target. The target arrays are only changed
+     under the offThreadLock, so they can be checked from the other thread here.
+     */
+    void queueOffThreadChange (const NodeListener& listener, OffThreadChange change)
+    {
+        {
+            const juce::ScopedLock lock (offThreadLock);
+            if (change.type == OffThreadChange::propertyChanged) {
+                if (! listener.routesProperty (change.tree, change.property)) {
+                    return;
+                }
+                // changes of the same property are coalesced, the latest value is read when routed
+                const OffThreadKey key { getNodeKey (change.node), getNodeKey (change.tree),
+                                         change.property.getCharPointer().getAddress() };
+                if (offThreadIndex.insert (key).second) {
+                    offThreadChanges.push_back (std::move (change));
+                }
+            }
+            else {
+                if (! listener.routesChildren (change.tree)) {
+                    return;
+                }
+                offThreadChanges.push_back (std::move (change));
+            }
+        }
+        triggerAsyncUpdate();
+    }
+
+    void handleAsyncUpdate () override
+    {
+        std::vector<OffThreadChange> changes;
+        {
+            const juce::ScopedLock lock (offThreadLock);
+            changes.swap (offThreadChanges);
+            offThreadIndex.clear();
+        }
+
+        beginBatch();
+        for (auto& change : changes) {
+            // the node may have lost all its targets in the meantime
+            auto* listener = findNodeListener (change.node);
+            if (listener == nullptr) {
+                continue;
+            }
+            switch (change.type) {
+                case OffThreadChange::propertyChanged:
+                    listener->valueTreePropertyChanged (change.tree, change.property);
+                    break;
+                case OffThreadChange::childAdded:
+                    listener->valueTreeChildAdded (change.tree, change.child);
+                    break;
+                case OffThreadChange::childRemoved:
+                    // the children may have changed again since, so the index is kept in range
+                    listener->valueTreeChildRemoved (change.tree, change.child,
+                                                     juce::jmin (change.index, change.tree.getNumChildren()));
+                    break;
+                case OffThreadChange::childOrderChanged:
+                    routeOffThreadMove (*listener, change);
+                    break;
+                default:
+                    jassertfalse;
+                    break;
+            }
+        }
+        endBatch();
+    }
+
+    /** Routes a move with the index the moved child has now, a child removed since isn't routed */
+    void routeOffThreadMove (NodeListener& listener, OffThreadChange& change)
+    {
+        const int newIndex = change.tree.indexOf (change.child);
+        if (newIndex < 0) {
+            return;
+        }
+        const int oldIndex = juce::jlimit (0, change.tree.getNumChildren() - 1, change.index);
+        listener.valueTreeChildOrderChanged (change.tree, oldIndex, newIndex);
+    }
+
+    /**
+     A ValueTree has no id, but the property set lives in the shared node, so its
+     address identifies the node for as long as the router holds a copy of it.
+     */
+    static const void* getNodeKey (const juce::ValueTree& node) noexcept
+    {
+        return &node.getProperties();
+    }
+
+    NodeListener* findNodeListener (const juce::ValueTree& node)
+    {
+        // attachments are usually created in runs on the same node
+        if (lastNode != nullptr && lastNode->node == node) {
+            return lastNode;
+        }
+        auto entry = nodes.find (getNodeKey (node));
+        if (entry == nodes.end()) {
+            return nullptr;
+        }
+        lastNode = entry->second.get();
+        return lastNode;
+    }
+
+    NodeListener& getOrCreateNodeListener (const juce::ValueTree& node)
+    {
+        // Don't route an invalid valuetree!
+        jassert (node.isValid());
+
+        pruneUnusedNodes();
+
+        if (auto* listener = findNodeListener (node)) {
+            return *listener;
+        }
+        auto& listener = nodes [getNodeKey (node)];
+        listener = std::make_unique<NodeListener> (*this, node);
+        lastNode = listener.get();
+        return *lastNode;
+    }
+
+    void removeIfUnused (NodeListener* listener)
+    {
+        if (listener->isUnused()) {
+            // a node listener must not be deleted from within its own callback,
+            // so it is left for the next add or remove outside of a dispatch
+            if (dispatchDepth == 0) {
+                removeNodeListener (listener);
+            }
+            else {
+                pruneNeeded = true;
+            }
+        }
+    }
+
+    void pruneUnusedNodes ()
+    {
+        if (pruneNeeded && dispatchDepth == 0) {
+            pruneNeeded = false;
+            for (auto entry = nodes.begin(); entry != nodes.end();) {
+                if (entry->second->isUnused()) {
+                    if (lastNode == entry->second.get()) {
+                        lastNode = nullptr;
+                    }
+                    entry = nodes.erase (entry);
+                }
+                else {
+                    ++entry;
+                }
+            }
+        }
+    }
+
+    void removeNodeListener (NodeListener* listener)
+    {
+        if (lastNode == listener) {
+            lastNode = nullptr;
+        }
+        nodes.erase (getNodeKey (listener->node));
+    }
+
+    std::unordered_map<const void*, std::unique_ptr<NodeListener>> nodes;
+    NodeListener*                               lastNode      = nullptr;
+    Iteration*                                  iterations    = nullptr;
+    int                                         dispatchDepth = 0;
+    bool                                        pruneNeeded   = false;
+
+    juce::ListenerList<Observer>                observers;
+
+    juce::Array<juce::ValueTree>                batchRoots;
+    std::vector<PendingChange>                  pendingChanges;
+    std::vector<PendingChange>*                 flushingChanges = nullptr;
+    std::unordered_map<PendingKey, size_t, PendingKeyHash> pendingIndex;
+    std::vector<Target*>                        batchedTargets;
+    std::vector<Target*>*                       endingBatchTargets = nullptr;
+
+    juce::CriticalSection                       offThreadLock;
+    std::vector<OffThreadChange>                offThreadChanges;
+    std::unordered_set<OffThreadKey, OffThreadKeyHash> offThreadIndex;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeAttachmentRouter)
+};
@@ -0,0 +1,189 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentSet.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ \class ValueTreeAttachmentSet
+ \brief Owns many attachments in contiguous storage
+
+ Instead of allocating each attachment with new, an editor with thousands of
+ controls can create them in a ValueTreeAttachmentSet. The attachments are
+ placed one after another in large blocks, so opening the editor needs only a
+ few allocations and the dispatch touches neighbouring memory. The attachments
+ never move, until they are destroyed all at once by clear() or the destructor,
+ in reverse order of creation.
+
+ \code{.cpp}
+    ValueTreeAttachmentSet attachments;
+    for (auto* slider : sliders)
+        attachments.add<ValueTreeSliderAttachment> (tree, slider->getComponentID(), *slider);
+ \endcode
+
+ Detach all attachments, before the components or the tree are destroyed.
+ */
+class ValueTreeAttachmentSet
+{
+public:
+    /** Creates a set, which allocates blocks of \param blockSizeInBytes */
+    explicit ValueTreeAttachmentSet (size_t blockSizeInBytes = 64 * 1024)
+    :   blockSize (blockSizeInBytes)
+    {
+    }
+
+    ~ValueTreeAttachmentSet ()
+    {
+        clear();
+    }
+
+    /**
+     Creates an attachment of AttachmentType in the set, forwarding the arguments
+     to its constructor, and returns it. The set stays the owner.
+     */
+    template<typename AttachmentType, typename... Args>
+    AttachmentType& add (Args&&... args)
+    {
+        void* memory = allocate (sizeof (AttachmentType), alignof (AttachmentType));
+        auto* attachment = new (memory) AttachmentType (std::forward<Args> (args)...);
+        entries.push_back ({ attachment, [] (void* object) { static_cast<AttachmentType*> (object)->~AttachmentType(); } });
+        usedBytes += sizeof (AttachmentType);
+        return *attachment;
+    }
+
+    /** Reserves space for the bookkeeping of \param numAttachments attachments */
+    void reserve (size_t numAttachments)
+    {
+        entries.reserve (numAttachments);
+    }
+
+    /** Detaches and destroys all attachments, keeping the first block for reuse */
+    void clear ()
+    {
+        for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+            entry->destroy (entry->object);
+        }
+        entries.clear();
+        usedBytes = 0;
+        if (! blocks.empty()) {
+            blocks.erase (blocks.begin() + 1, blocks.end());
+            blocks.front().used = 0;
+        }
+    }
+
+    int getNumAttachments () const
+    {
+        return static_cast<int> (entries.size());
+    }
+
+    /** Returns the bytes taken by the attachments themselves */
+    size_t getUsedBytes () const
+    {
+        return usedBytes;
+    }
+
+    /** Returns all bytes allocated by the set, including the bookkeeping */
+    size_t getAllocatedBytes () const
+    {
+        size_t bytes = sizeof (*this) + entries.capacity() * sizeof (Entry) + blocks.capacity() * sizeof (Block);
+        for (auto& block : blocks) {
+            bytes += block.size;
+        }
+        return bytes;
+    }
+
+    /** Returns the number of blocks allocated for the attachments */
+    int getNumBlocks () const
+    {
+        return static_cast<int> (blocks.size());
+    }
+
+private:
+    struct Entry
+    {
+        void* object;
+        void (*destroy) (void*);
+    };
+
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        size_t                  size = 0;
+        size_t                  used = 0;
+    };
+
+    void* allocate (size_t size, size_t alignment)
+    {
+        // attachments with extended alignment are not supported
+        jassert (alignment <= alignof (std::max_align_t));
+
+        if (! blocks.empty()) {
+            Block& block = blocks.back();
+            const size_t offset = (block.used + alignment - 1) & ~(alignment - 1);
+            if (offset + size <= block.size) {
+                block.used = offset + size;
+                return block.data.get() + offset;
+            }
+        }
+        // new blocks come from operator new[], which is aligned for any standard type
+        Block block;
+        block.size = juce::jmax (blockSize, size);
+        block.data.reset (new char [block.size]);
+        block.used = size;
+        blocks.push_back (std::move (block));
+        return blocks.back().data.get();
+    }
+
+    const size_t        blockSize;
+    std::vector<Block>  blocks;
+    std::vector<Entry>  entries;
+    size_t              usedBytes = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeAttachmentSet)
+};
@@ -0,0 +1,331 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentStats.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+/**
+ \class ValueTreeAttachmentStats
+ \brief Counters and latency histograms per attachment, to find the hottest controls
+
+ With FF_ATTACHMENT_STATS enabled, every attachment registers a binding in the
+ shared table and counts its tree to GUI updates, GUI to tree writes, suppressed
+ echoes and writes of an unchanged value. The time spent in each callback is
+ added to a histogram with power of two buckets in microseconds, separately for
+ both directions.
+
+ The counters of a binding are packed in one fixed size entry, the names are kept
+ apart, so counting touches only one entry. getTopBindings() returns a snapshot of
+ the bindings that took the most time:
+
+ \code{.cpp}
+    juce::SharedResourcePointer<ValueTreeAttachmentStats> stats;
+    for (const auto& binding : stats->getTopBindings (10)) {
+        DBG (binding.name + ": " + juce::String (binding.getTotalSeconds() * 1000.0) + " ms");
+    }
+ \endcode
+
+ When FF_ATTACHMENT_STATS is 0, which is the default, Binding and ScopedTimer
+ are empty and the attachments register nothing. Use it on the message thread only.
+ */
+class ValueTreeAttachmentStats
+{
+public:
+    enum Counter
+    {
+        treeToComponentUpdates = 0,
+        componentToTreeWrites,
+        suppressedEchoes,
+        unchangedWrites,
+        numCounters
+    };
+
+    enum Direction
+    {
+        treeToComponent = 0,
+        componentToTree,
+        numDirections
+    };
+
+    /** Bucket i counts callbacks shorter than 2^i microseconds, the last one all longer ones */
+    static constexpr int numBuckets = 16;
+
+    /** A copy of the counters of one binding */
+    struct Snapshot
+    {
+        juce::String name;
+        juce::uint32 counters   [numCounters]   = {};
+        juce::uint32 histograms [numDirections][numBuckets] = {};
+        juce::int64  ticks      [numDirections] = {};
+
+        double getTotalSeconds () const
+        {
+            return juce::Time::highResolutionTicksToSeconds (ticks [treeToComponent] + ticks [componentToTree]);
+        }
+
+        /** Returns the upper bound in microseconds of the bucket containing the \param percentile (0..100) */
+        double getPercentileMicroseconds (Direction direction, double percentile) const
+        {
+            juce::uint64 total = 0;
+            for (auto count : histograms [direction]) {
+                total += count;
+            }
+            const double threshold = static_cast<double> (total) * percentile / 100.0;
+            juce::uint64 sum = 0;
+            for (int i=0; i < numBuckets; ++i) {
+                sum += histograms [direction][i];
+                if (sum > 0 && static_cast<double> (sum) >= threshold) {
+                    return static_cast<double> (1 << i);
+                }
+            }
+            return 0.0;
+        }
+    };
+
+    ValueTreeAttachmentStats () = default;
+
+    /** Adds a binding and returns its index in the table */
+    int addBinding (const juce::String& name)
+    {
+        int index = -1;
+        if (freeEntries.empty()) {
+            index = static_cast<int> (entries.size());
+            entries.emplace_back();
+            names.add (name);
+        }
+        else {
+            index = freeEntries.back();
+            freeEntries.pop_back();
+            entries [static_cast<size_t> (index)] = Entry();
+            names.set (index, name);
+        }
+        entries [static_cast<size_t> (index)].used = true;
+        return index;
+    }
+
+    /** Frees the entry of a binding, the index is reused by the next binding */
+    void removeBinding (int index)
+    {
+        jassert (juce::isPositiveAndBelow (index, static_cast<int> (entries.size())));
+        entries [static_cast<size_t> (index)].used = false;
+        names.set (index, juce::String());
+        freeEntries.push_back (index);
+    }
+
+    void count (int index, Counter counter) noexcept
+    {
+        ++entries [static_cast<size_t> (index)].counters [counter];
+    }
+
+    void addTime (int index, Direction direction, juce::int64 ticks) noexcept
+    {
+        Entry& entry = entries [static_cast<size_t> (index)];
+        entry.ticks [direction] += ticks;
+        ++entry.histograms [direction][getBucket (ticks)];
+    }
+
+    /** Returns up to \param maxNumBindings bindings, that took the most time, the hottest first */
+    std::vector<Snapshot> getTopBindings (int maxNumBindings) const
+    {
+        std::vector<int> used;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries [i].used) {
+                used.push_back (static_cast<int> (i));
+            }
+        }
+        const auto totalTicks = [this] (int index) {
+            const Entry& entry = entries [static_cast<size_t> (index)];
+            return entry.ticks [treeToComponent] + entry.ticks [componentToTree];
+        };
+        const size_t num = std::min (used.size(), static_cast<size_t> (juce::jmax (0, maxNumBindings)));
+        std::partial_sort (used.begin(), used.begin() + static_cast<std::ptrdiff_t> (num), used.end(),
+                           [&] (int a, int b) { return totalTicks (a) > totalTicks (b); });
+
+        std::vector<Snapshot> snapshots (num);
+        for (size_t i = 0; i < num; ++i) {
+            const Entry& entry = entries [static_cast<size_t> (used [i])];
+            Snapshot& snapshot = snapshots [i];
+            snapshot.name = names [used [i]];
+            std::copy (std::begin (entry.counters), std::end (entry.counters), std::begin (snapshot.counters));
+            for (int d = 0; d < numDirections; ++d) {
+                std::copy (std::begin (entry.histograms [d]), std::end (entry.histograms [d]), std::begin (snapshot.histograms [d]));
+                snapshot.ticks [d] = entry.ticks [d];
+            }
+        }
+        return snapshots;
+    }
+
+    /** Sets all counters of the registered bindings to zero */
+    void reset ()
+    {
+        for (auto& entry : entries) {
+            const bool used = entry.used;
+            entry = Entry();
+            entry.used = used;
+        }
+    }
+
+    static const char* getCounterName (int counter)
+    {
+        switch (counter) {
+            case treeToComponentUpdates: return "tree to component updates";
+            case componentToTreeWrites:  return "component to tree writes";
+            case suppressedEchoes:       return "suppressed echoes";
+            case unchangedWrites:        return "unchanged writes";
+            default:                     return "unknown";
+        }
+    }
+
+#if FF_ATTACHMENT_STATS
+    class ScopedTimer;
+
+    /**
+     The entry of one attachment, registered while it exists. The attachments
+     derive from it privately, so it takes no space when the stats are disabled.
+     An attachment that leaves the work to an inner attachment passes false for
+     \p shouldRegister, so the component is counted only once.
+     */
+    class Binding
+    {
+    public:
+        Binding (const juce::Identifier& property, const juce::Component* component, bool shouldRegister = true)
+        {
+            if (shouldRegister) {
+                bindingIndex = registry->addBinding (property.toString() + (component != nullptr ? " (" + component->getComponentID() + ")" : juce::String()));
+            }
+        }
+
+        ~Binding ()
+        {
+            if (bindingIndex >= 0) {
+                registry->removeBinding (bindingIndex);
+            }
+        }
+
+        Binding& getBindingStats () noexcept
+        {
+            return *this;
+        }
+
+        void count (Counter counter) noexcept
+        {
+            if (bindingIndex >= 0) {
+                registry->count (bindingIndex, counter);
+            }
+        }
+
+    private:
+        friend class ScopedTimer;
+        juce::SharedResourcePointer<ValueTreeAttachmentStats> registry;
+        int bindingIndex = -1;
+        JUCE_DECLARE_NON_COPYABLE (Binding)
+    };
+
+    /** Adds the time until it goes out of scope to the histogram of a binding */
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer (Binding& bindingToTime, Direction directionToTime) noexcept
+        :   binding   (bindingToTime),
+            direction (directionToTime),
+            start     (juce::Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedTimer ()
+        {
+            if (binding.bindingIndex >= 0) {
+                binding.registry->addTime (binding.bindingIndex, direction, juce::Time::getHighResolutionTicks() - start);
+            }
+        }
+
+    private:
+        Binding&    binding;
+        Direction   direction;
+        juce::int64 start;
+        JUCE_DECLARE_NON_COPYABLE (ScopedTimer)
+    };
+#else
+    class Binding
+    {
+    public:
+        Binding (const juce::Identifier&, const juce::Component*, bool = true) noexcept {}
+        Binding& getBindingStats () noexcept { return *this; }
+        void count (Counter) noexcept {}
+    };
+
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer (Binding&, Direction) noexcept {}
+    };
+#endif
+
+private:
+    struct Entry
+    {
+        juce::uint32 counters   [numCounters] = {};
+        juce::uint32 histograms [numDirections][numBuckets] = {};
+        juce::int64  ticks      [numDirections] = {};
+        bool         used = false;
+    };
+
+    static int getBucket (juce::int64 ticks) noexcept
+    {
+        const auto micros = static_cast<juce::int64> (juce::Time::highResolutionTicksToSeconds (ticks) * 1.0e6);
+        int bucket = 0;
+        while (bucket < numBuckets - 1 && (juce::int64 (1) << bucket) <= micros) {
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    std::vector<Entry> entries;
+    juce::StringArray  names;
+    std::vector<int>   freeEntries;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeAttachmentStats)
+};
@@ -0,0 +1,155 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentSync.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/**
+ \class ValueTreeAttachmentTypedSync
+ \brief Suppresses the echo of values travelling between a ValueTree and a component
+
+ Every attachment owns one ValueTreeAttachmentTypedSync per binding. While the
+ attachment writes to one side, ScopedUpdate marks the binding as busy, so the
+ synchronous callback from that side is dropped. It also remembers the value
+ last seen on either side. A value coming back later, e.g. through an async
+ notification, compares equal to it and is dropped as well. So a tree to GUI
+ update never causes a GUI to tree write and vice versa.
+
+ The ValueType is the type the component works with, e.g. double for a Slider,
+ so the values are compared without converting them to a juce::var.
+ */
+template<typename ValueType>
+class ValueTreeAttachmentTypedSync
+{
+public:
+    ValueTreeAttachmentTypedSync () = default;
+
+    /**
+     Marks the binding as busy while the attachment writes to the tree or the
+     component. All callbacks arriving synchronously in that time are echoes.
+     */
+    class ScopedUpdate
+    {
+    public:
+        explicit ScopedUpdate (ValueTreeAttachmentTypedSync& syncToUse) : sync (syncToUse)
+        {
+            ++sync.updateDepth;
+        }
+
+        ~ScopedUpdate ()
+        {
+            --sync.updateDepth;
+        }
+
+    private:
+        ValueTreeAttachmentTypedSync& sync;
+        JUCE_DECLARE_NON_COPYABLE (ScopedUpdate)
+    };
+
+    /**
+     Returns true, if the value from the tree is new to this binding and the
+     component needs an update. Call componentUpdated after updating it.
+     */
+    bool shouldUpdateComponent (const ValueType& treeValue)
+    {
+        if (isUpdating() || (hasTreeValue && treeValue == lastTreeValue)) {
+            return false;
+        }
+        lastTreeValue = treeValue;
+        hasTreeValue  = true;
+        return true;
+    }
+
+    /**
+     Records the value the component shows after a tree to GUI update. The component
+     may have snapped or clamped the value, and its notification must not be
+     taken for a user edit.
+     */
+    void componentUpdated (const ValueType& componentValue)
+    {
+        lastComponentValue = componentValue;
+        hasComponentValue  = true;
+    }
+
+    /**
+     Returns true, if the value of the component was changed by the user and should
+     be written to the tree.
+     */
+    bool shouldWriteToTree (const ValueType& componentValue)
+    {
+        if (isUpdating() || (hasComponentValue && componentValue == lastComponentValue)) {
+            return false;
+        }
+        lastComponentValue = componentValue;
+        lastTreeValue      = componentValue;
+        hasComponentValue  = true;
+        hasTreeValue       = true;
+        return true;
+    }
+
+    /**
+     Forgets the synced values, so the next value from either side is taken as new.
+     Use this, when the component lost its state, e.g. a ComboBox was refilled.
+     */
+    void reset ()
+    {
+        hasTreeValue      = false;
+        hasComponentValue = false;
+    }
+
+    /** Returns true while a ScopedUpdate is alive */
+    bool isUpdating () const
+    {
+        return updateDepth > 0;
+    }
+
+private:
+    // the initial values may equal the first synced value, so that always has to pass
+    ValueType    lastTreeValue      {};
+    ValueType    lastComponentValue {};
+    bool         hasTreeValue      = false;
+    bool         hasComponentValue = false;
+    int          updateDepth       = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeAttachmentTypedSync)
+};
@@ -0,0 +1,188 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentVisibilityWatcher.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ \class ValueTreeAttachmentVisibilityWatcher
+ \brief Tells attachments, when their component may have become visible
+
+ JUCE reports a visibility change only to the listeners of the component that
+ was shown or hidden, so a component on a hidden tab has to watch all of its
+ parents. Instead of every attachment registering a ComponentListener with each
+ parent, the watcher registers once per component and keeps the clients below
+ each watched component in a hash set. Watching N controls in a hierarchy of
+ depth D costs N * D hash insertions, independent of how many controls share a
+ parent.
+
+ All attachments share one watcher through a juce::SharedResourcePointer. It is
+ used on the message thread only.
+ */
+class ValueTreeAttachmentVisibilityWatcher : private juce::ComponentListener
+{
+public:
+    /**
+     The interface an attachment implements to be told about visibility changes
+     */
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        /** The watched component or one of its parents was shown, hidden or moved */
+        virtual void watchedVisibilityChanged () = 0;
+    };
+
+    ValueTreeAttachmentVisibilityWatcher () = default;
+
+    ~ValueTreeAttachmentVisibilityWatcher () override
+    {
+        for (auto& entry : watched) {
+            entry.first->removeComponentListener (this);
+        }
+    }
+
+    /** Watches \param component and all its parents for \param client */
+    void watch (juce::Component& component, Client* client)
+    {
+        unwatch (client);
+        auto& chain = chains [client];
+        for (juce::Component* c = &component; c != nullptr; c = c->getParentComponent()) {
+            auto& clients = watched [c];
+            if (clients.empty()) {
+                c->addComponentListener (this);
+            }
+            clients.insert (client);
+            chain.push_back (c);
+        }
+    }
+
+    /** Stops watching for \param client, call this before the client is destroyed */
+    void unwatch (Client* client)
+    {
+        auto chain = chains.find (client);
+        if (chain == chains.end()) {
+            return;
+        }
+        for (auto* c : chain->second) {
+            auto entry = watched.find (c);
+            if (entry != watched.end()) {
+                entry->second.erase (client);
+                if (entry->second.empty()) {
+                    c->removeComponentListener (this);
+                    watched.erase (entry);
+                }
+            }
+        }
+        chains.erase (chain);
+    }
+
+    /** Returns the number of components the watcher has registered with */
+    int getNumWatchedComponents () const
+    {
+        return static_cast<int> (watched.size());
+    }
+
+private:
+    void componentVisibilityChanged (juce::Component& component) override
+    {
+        for (auto* client : getClients (component)) {
+            if (isWatching (component, client)) {
+                client->watchedVisibilityChanged();
+            }
+        }
+    }
+
+    /** JUCE calls this for every component below the one that got a new parent */
+    void componentParentHierarchyChanged (juce::Component& component) override
+    {
+        for (auto* client : getClients (component)) {
+            auto chain = chains.find (client);
+            // only the client's own component rewatches, so each client does it once
+            if (chain != chains.end() && ! chain->second.empty() && chain->second.front() == &component) {
+                watch (component, client);
+                client->watchedVisibilityChanged();
+            }
+        }
+    }
+
+    void componentBeingDeleted (juce::Component& component) override
+    {
+        auto entry = watched.find (&component);
+        if (entry == watched.end()) {
+            return;
+        }
+        for (auto* client : entry->second) {
+            auto& chain = chains [client];
+            chain.erase (std::remove (chain.begin(), chain.end(), &component), chain.end());
+        }
+        watched.erase (entry);
+    }
+
+    /** A copy, because the clients may watch or unwatch while being called */
+    std::vector<Client*> getClients (juce::Component& component) const
+    {
+        auto entry = watched.find (&component);
+        if (entry == watched.end()) {
+            return {};
+        }
+        return std::vector<Client*> (entry->second.begin(), entry->second.end());
+    }
+
+    bool isWatching (juce::Component& component, Client* client) const
+    {
+        auto entry = watched.find (&component);
+        return entry != watched.end() && entry->second.count (client) > 0;
+    }
+
+    std::unordered_map<juce::Component*, std::unordered_set<Client*>> watched;
+    std::unordered_map<Client*, std::vector<juce::Component*>>        chains;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeAttachmentVisibilityWatcher)
+};
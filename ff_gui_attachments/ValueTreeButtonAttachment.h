@@ -4,74 +4,50 @@
 
 #pragma once
 
-#include <mutex>
-
-class ValueTreeButtonAttachment : public juce::Button::Listener,
-                                  public juce::ValueTree::Listener
+/** Binds the toggle state of a Button, see ValueTreeAttachment */
+struct ValueTreeButtonTraits
 {
-public:
-    ValueTreeButtonAttachment (juce::ValueTree& tree,
-                               juce::Button* button,
-                               juce::Identifier property,
-                               juce::UndoManager* undo = nullptr)
-        :   tree_ (tree),
-            property_ (property),
-            undo_ (undo)
-    {
-        // Don't attach an invalid valuetree!
-        jassert (tree_.isValid());
-        button_ = button;
+    using ValueType = bool;
 
-        if (tree_.hasProperty (property))
-        {
-            button_->setToggleState (tree_.getProperty(property_), juce::NotificationType::dontSendNotification);
-        }
-        else
-        {
-            tree_.setProperty (property, button_->getToggleState(), undo_);
-        }
+    static ValueType getValue (const juce::Button& button)
+    {
+        return button.getToggleState();
+    }
 
-        tree_.addListener (this);
-        button_->addListener (this);
+    static void setValue (juce::Button& button, ValueType value, juce::NotificationType notification)
+    {
+        button.setToggleState (value, notification);
     }
 
-    ~ValueTreeButtonAttachment () override
+    static constexpr juce::NotificationType initialNotification = juce::dontSendNotification;
+    static constexpr juce::NotificationType updateNotification  = juce::sendNotificationAsync;
+};
+
+class ValueTreeButtonAttachment : public ValueTreeAttachment<juce::Button, ValueTreeButtonTraits>,
+                                  public juce::Button::Listener
+{
+public:
+    ValueTreeButtonAttachment (juce::ValueTree& attachToTree,
+                               juce::Button* buttonToAttach,
+                               juce::Identifier toggleProperty,
+                               juce::UndoManager* undoManagerToUse = nullptr)
+        :   ValueTreeAttachment (attachToTree, buttonToAttach, std::move (toggleProperty), undoManagerToUse)
     {
-        tree_.removeListener (this);
-        if (button_) {
-            button_->removeListener (this);
-        }
+        buttonToAttach->addListener (this);
     }
 
-    void buttonClicked (juce::Button *button) override
+    ~ValueTreeButtonAttachment () override
     {
-        if (std::unique_lock lock{mutex_, std::try_to_lock}; lock)
-        {
-            if (button_ == button)
-            {
-                tree_.setProperty(property_, button_->getToggleState(), undo_);
-            }
+        if (component) {
+            component->removeListener (this);
         }
     }
 
-    void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &changedProperty) override
+    void buttonClicked (juce::Button *buttonThatWasClicked) override
     {
-        if (std::unique_lock lock{mutex_, std::try_to_lock}; lock)
+        if (component == buttonThatWasClicked)
         {
-            if (treeWhosePropertyHasChanged == tree_ && button_)
-            {
-                if (changedProperty == property_)
-                {
-                    button_->setToggleState (tree_.getProperty(property_), juce::NotificationType::sendNotificationAsync);
-                }
-            }
+            writeToTree();
         }
     }
-
-private:
-    juce::ValueTree                             tree_;
-    juce::Component::SafePointer<juce::Button>  button_;
-    juce::Identifier                            property_;
-    juce::UndoManager*                          undo_ = nullptr;
-    std::mutex                                  mutex_;
-};
\ No newline at end of file
+};
@@ -0,0 +1,301 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeCascadeAnalyzer.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+/**
+ \class ValueTreeCascadeAnalyzer
+ \brief Measures how many attachment callbacks each external change of a tree causes
+
+ Attachments on overlapping nodes can bounce a change back and forth, the echo
+ guards only stop that inside one attachment. The analyzer listens to the tree
+ and observes the shared ValueTreeAttachmentRouter. A change made outside of any
+ attachment callback opens a cascade, which collects all callbacks and writes
+ it triggers, until the next external change.
+
+ The statistics give the amplification, i.e. callbacks per external write, and
+ the deepest nesting of callbacks. Within a cascade it flags writes that set a
+ property back to a value it already had (a cycle), and attachments that are
+ called twice for the same unchanged value (a redundant update). The numbers
+ are meant to be asserted on in tests:
+
+ \code{.cpp}
+    ValueTreeCascadeAnalyzer analyzer (tree);
+    tree.setProperty ("gain", 0.5, nullptr);
+    jassert (analyzer.getStats().getAmplification() <= 2.0);
+    jassert (analyzer.getStats().cycles == 0);
+ \endcode
+
+ Only callbacks for the watched tree and its children are counted, though the
+ router is shared by all trees in the process. Other observers of the router,
+ e.g. a profiling ValueTreeDebugListener, are called as usual. Use it on the message thread only.
+ */
+class ValueTreeCascadeAnalyzer : public juce::ValueTree::Listener,
+                                 private ValueTreeAttachmentRouter::Observer
+{
+public:
+    struct Stats
+    {
+        juce::int64 externalWrites   = 0;  ///< changes made outside of attachment callbacks
+        juce::int64 nestedWrites     = 0;  ///< changes made by attachment callbacks
+        juce::int64 callbacks        = 0;  ///< attachment callbacks in total
+        juce::int64 redundantUpdates = 0;  ///< callbacks repeating one for the same target and value
+        juce::int64 cycles           = 0;  ///< writes returning a property to an earlier value of the cascade
+        int         maxDepth         = 0;  ///< deepest nesting of attachment callbacks
+        int         maxCallbacks     = 0;  ///< most callbacks caused by a single cascade
+
+        /** Returns the callbacks per external write */
+        double getAmplification () const
+        {
+            return externalWrites > 0 ? static_cast<double> (callbacks) / static_cast<double> (externalWrites) : 0.0;
+        }
+    };
+
+    /**
+     Create an analyzer for \param treeToWatch and all its children. Up to
+     \param maxFindings descriptions of cycles and redundant updates are kept.
+     */
+    ValueTreeCascadeAnalyzer (juce::ValueTree& treeToWatch, int maxFindings = 100)
+      : tree (treeToWatch),
+        findingsLimit (maxFindings)
+    {
+        // Don't attach an invalid valuetree!
+        jassert (tree.isValid());
+        router->addObserver (this);
+        tree.addListener (this);
+    }
+
+    ~ValueTreeCascadeAnalyzer ()
+    {
+        tree.removeListener (this);
+        router->removeObserver (this);
+    }
+
+    const Stats& getStats () const
+    {
+        return stats;
+    }
+
+    /** Returns the descriptions of the cycles and redundant updates found so far */
+    const juce::StringArray& getFindings () const
+    {
+        return findings;
+    }
+
+    void reset ()
+    {
+        stats = Stats();
+        findings.clear();
+        cascade = Cascade();
+    }
+
+    /** Writes the statistics and findings as text */
+    void writeReport (juce::OutputStream& out) const
+    {
+        out << "external writes:   " << juce::String (stats.externalWrites) << "\n"
+            << "nested writes:     " << juce::String (stats.nestedWrites) << "\n"
+            << "callbacks:         " << juce::String (stats.callbacks) << "\n"
+            << "amplification:     " << juce::String (stats.getAmplification(), 2) << "\n"
+            << "max depth:         " << juce::String (stats.maxDepth) << "\n"
+            << "max callbacks:     " << juce::String (stats.maxCallbacks) << "\n"
+            << "redundant updates: " << juce::String (stats.redundantUpdates) << "\n"
+            << "cycles:            " << juce::String (stats.cycles) << "\n";
+        for (const auto& finding : findings) {
+            out << finding << "\n";
+        }
+    }
+
+    void valueTreePropertyChanged (juce::ValueTree& treeWhosePropertyHasChanged, const juce::Identifier& property) override
+    {
+        const juce::var value = treeWhosePropertyHasChanged.getProperty (property);
+        if (depth > 0) {
+            ++stats.nestedWrites;
+            addWrite (treeWhosePropertyHasChanged, property, value);
+            return;
+        }
+
+        ++stats.externalWrites;
+        // the router may have dispatched this change before the analyzer got it
+        if (cascade.callbacks > 0 && ! cascade.originWritten && isOrigin (treeWhosePropertyHasChanged, property)) {
+            cascade.originWritten = true;
+            cascade.closed        = true;
+        }
+        else {
+            startCascade (treeWhosePropertyHasChanged, property);
+            cascade.originWritten = true;
+        }
+        addWrite (treeWhosePropertyHasChanged, property, value);
+    }
+
+private:
+    struct Write
+    {
+        juce::ValueTree  node;
+        juce::Identifier property;
+        juce::Array<juce::var> values;
+    };
+
+    struct Update
+    {
+        ValueTreeAttachmentRouter::Target* target;
+        juce::ValueTree  node;
+        juce::Identifier property;
+        juce::var        value;
+    };
+
+    /** All writes and callbacks caused by one external change */
+    struct Cascade
+    {
+        juce::ValueTree     node;
+        juce::Identifier    property;
+        std::vector<Write>  writes;
+        std::vector<Update> updates;
+        int                 callbacks     = 0;
+        bool                originWritten = false;
+        bool                closed        = false;
+    };
+
+    void targetCallbackStarted (ValueTreeAttachmentRouter::Target* target, const juce::ValueTree& node, const juce::Identifier& property) override
+    {
+        // the router is shared, callbacks for other trees must not count
+        const bool watched = node == tree || node.isAChildOf (tree);
+        callbackStack.push_back (watched);
+        if (! watched) {
+            return;
+        }
+
+        if (depth == 0 && (cascade.closed || ! isOrigin (node, property))) {
+            startCascade (node, property);
+        }
+        ++depth;
+        ++stats.callbacks;
+        ++cascade.callbacks;
+        stats.maxDepth     = juce::jmax (stats.maxDepth, depth);
+        stats.maxCallbacks = juce::jmax (stats.maxCallbacks, cascade.callbacks);
+
+        if (property.isValid()) {
+            const juce::var value = node.getProperty (property);
+            for (const auto& update : cascade.updates) {
+                if (update.target == target && update.node == node && update.property == property && update.value == value) {
+                    ++stats.redundantUpdates;
+                    addFinding ("redundant update of " + describe (node, property) + " = " + value.toString());
+                    break;
+                }
+            }
+            cascade.updates.push_back ({ target, node, property, value });
+        }
+    }
+
+    void targetCallbackFinished (ValueTreeAttachmentRouter::Target*) override
+    {
+        // an analyzer created inside a callback doesn't see that callback start
+        if (callbackStack.empty()) {
+            return;
+        }
+        if (callbackStack.back()) {
+            --depth;
+        }
+        callbackStack.pop_back();
+    }
+
+    void startCascade (const juce::ValueTree& node, const juce::Identifier& property)
+    {
+        cascade.node     = node;
+        cascade.property = property;
+        cascade.writes.clear();
+        cascade.updates.clear();
+        cascade.callbacks     = 0;
+        cascade.originWritten = false;
+        cascade.closed        = false;
+    }
+
+    bool isOrigin (const juce::ValueTree& node, const juce::Identifier& property) const
+    {
+        return cascade.node == node && cascade.property == property;
+    }
+
+    /** Remembers the value written and flags it, if the property had it before in this cascade */
+    void addWrite (const juce::ValueTree& node, const juce::Identifier& property, const juce::var& value)
+    {
+        for (auto& write : cascade.writes) {
+            if (write.node == node && write.property == property) {
+                if (write.values.contains (value)) {
+                    ++stats.cycles;
+                    addFinding ("cycle on " + describe (node, property) + " back to " + value.toString() +
+                                " in cascade of " + describe (cascade.node, cascade.property));
+                }
+                write.values.add (value);
+                return;
+            }
+        }
+        Write write { node, property, {} };
+        write.values.add (value);
+        cascade.writes.push_back (std::move (write));
+    }
+
+    void addFinding (const juce::String& finding)
+    {
+        if (findings.size() < findingsLimit) {
+            findings.add (finding);
+        }
+    }
+
+    static juce::String describe (const juce::ValueTree& node, const juce::Identifier& property)
+    {
+        return "<" + node.getType().toString() + "> \"" + (property.isValid() ? property.toString() : juce::String()) + "\"";
+    }
+
+    juce::SharedResourcePointer<ValueTreeAttachmentRouter> router;
+    juce::ValueTree   tree;
+    int               findingsLimit;
+    int               depth = 0;
+    std::vector<bool> callbackStack;
+    Stats             stats;
+    Cascade           cascade;
+    juce::StringArray findings;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeCascadeAnalyzer)
+};
@@ -45,6 +45,63 @@
 
 #pragma once
 
+#include <memory>
+
+/** Binds the selected index of a ComboBox, see ValueTreeAttachment */
+struct ValueTreeComboBoxIndexTraits
+{
+    using ValueType = int;
+
+    static ValueType getValue (const juce::ComboBox& comboBox)
+    {
+        return comboBox.getSelectedItemIndex();
+    }
+
+    static void setValue (juce::ComboBox& comboBox, ValueType index, juce::NotificationType notification)
+    {
+        comboBox.setSelectedItemIndex (index, notification);
+    }
+
+    static constexpr juce::NotificationType initialNotification = juce::sendNotificationAsync;
+    static constexpr juce::NotificationType updateNotification  = juce::sendNotificationAsync;
+};
+
+/**
+ \class ValueTreeComboBoxIndexAttachment
+ \brief Stores the selected index of a ComboBox, that has its items already, in a property
+
+ This is the index mode of the ValueTreeComboBoxAttachment. Being a
+ ValueTreeAttachment it can also coalesce updates, skip updates while hidden and
+ publish the index to a ValueTreeParameterBlock.
+ */
+class ValueTreeComboBoxIndexAttachment : public ValueTreeAttachment<juce::ComboBox, ValueTreeComboBoxIndexTraits>,
+                                         public juce::ComboBox::Listener
+{
+public:
+    ValueTreeComboBoxIndexAttachment (juce::ValueTree& attachToTree,
+                                      juce::ComboBox* comboBoxToAttach,
+                                      juce::Identifier indexProperty,
+                                      juce::UndoManager* undoManagerToUse = nullptr)
+    :   ValueTreeAttachment (attachToTree, comboBoxToAttach, std::move (indexProperty), undoManagerToUse)
+    {
+        comboBoxToAttach->addListener (this);
+    }
+
+    ~ValueTreeComboBoxIndexAttachment () override
+    {
+        if (component) {
+            component->removeListener (this);
+        }
+    }
+
+    /** Updates the ValueTree's property if the selection has changed */
+    void comboBoxChanged (juce::ComboBox *comboBoxThatHasChanged) override
+    {
+        if (component == comboBoxThatHasChanged) {
+            writeToTree();
+        }
+    }
+};
 
 //==============================================================================
 /**
@@ -56,10 +113,18 @@
  property is used.
 
  selectSubNodes == false: The combobox has already it's items and the selected index 
- is stored in the property.
+ is stored in the property. This mode is handled by a ValueTreeComboBoxIndexAttachment,
+ which can also be used directly.
+
+ Appended, renamed and reordered child nodes update the items in place. Removing
+ or inserting a child rebuilds the items, because a ComboBox can only append.
+ Wrap bulk changes of the children in a ScopedAttachmentBatch, or in
+ beginBulkEdit() and endBulkEdit(), to rebuild only once at the end.
+ A ValueTreeDiff applies its changes in a batch already.
  */
 class ValueTreeComboBoxAttachment : public juce::ComboBox::Listener,
-                                    public juce::ValueTree::Listener
+                                    public ValueTreeAttachmentRouter::Target,
+                                    private ValueTreeAttachmentStats::Binding
 {
 public:
     /**
@@ -73,113 +138,166 @@ public:
                                  juce::Identifier indexProperty,
                                  bool shouldSelectSubNodes,
                                  juce::UndoManager* undoManagerToUse = nullptr)
-    :   tree (attachToTree),
+    :   ValueTreeAttachmentStats::Binding (indexProperty, comboBoxToAttach, shouldSelectSubNodes),
+        tree (attachToTree),
         property (indexProperty),
         selectSubNodes (shouldSelectSubNodes),
         undoMgr (undoManagerToUse)
     {
         // Don't attach an invalid valuetree!
         jassert (tree.isValid());
-        comboBox = comboBoxToAttach;
 
-        if (selectSubNodes) {
-            updateChoices ();
+        if (! selectSubNodes) {
+            indexAttachment = std::make_unique<ValueTreeComboBoxIndexAttachment> (attachToTree, comboBoxToAttach,
+                                                                                  indexProperty, undoManagerToUse);
+            return;
         }
-        else {
-            if (tree.hasProperty (property)) {
-                comboBox->setSelectedItemIndex (tree.getProperty(property));
-            }
-            else {
-                tree.setProperty (property, comboBox->getSelectedItemIndex(), undoMgr);
-            }
-        }
-        tree.addListener (this);
+        comboBox = comboBoxToAttach;
+        updateChoices ();
+        router->addChildPropertyTarget (tree, property, this);
+        router->addChildPropertyTarget (tree, FF::propSelected, this);
+        router->addChildrenTarget (tree, this);
         comboBox->addListener (this);
     }
 
     ~ValueTreeComboBoxAttachment ()
     {
-        tree.removeListener (this);
+        if (selectSubNodes) {
+            router->removeChildPropertyTarget (tree, property, this);
+            router->removeChildPropertyTarget (tree, FF::propSelected, this);
+            router->removeChildrenTarget (tree, this);
+        }
         if (comboBox) {
             comboBox->removeListener (this);
         }
     }
 
+    /** Returns the attachment handling the index mode, or nullptr if the sub nodes are selected */
+    ValueTreeComboBoxIndexAttachment* getIndexAttachment () const
+    {
+        return indexAttachment.get();
+    }
+
     /** Updates the ValueTree's property if the ComboBox has changed */
     void comboBoxChanged (juce::ComboBox *comboBoxThatHasChanged) override
     {
-        if (! updating) {
-            updating = true;
-            if (comboBox == comboBoxThatHasChanged) {
-                if (selectSubNodes) {
-                    const int idx = comboBox->getSelectedItemIndex ();
-                    for (int i=0; i < tree.getNumChildren(); ++i) {
-                        if (i == idx) {
-                            tree.getChild (i).setProperty (FF::propSelected, 1, undoMgr);
-                        }
-                        else {
-                            tree.getChild (i).removeProperty (FF::propSelected, undoMgr);
-                        }
-                    }
+        if (comboBox == comboBoxThatHasChanged) {
+            const ValueTreeAttachmentStats::ScopedTimer timer (getBindingStats(), ValueTreeAttachmentStats::componentToTree);
+            const int idx = comboBox->getSelectedItemIndex ();
+            if (! sync.shouldWriteToTree (idx)) {
+                getBindingStats().count (sync.isUpdating() ? ValueTreeAttachmentStats::suppressedEchoes
+                                                      : ValueTreeAttachmentStats::unchangedWrites);
+            }
+            else {
+                getBindingStats().count (ValueTreeAttachmentStats::componentToTreeWrites);
+                const ValueTreeAttachmentTypedSync<int>::ScopedUpdate scope (sync);
+                // only the previous and the new selection are touched
+                juce::ValueTree child = tree.getChild (idx);
+                if (selectedChild.isValid() && selectedChild != child) {
+                    selectedChild.removeProperty (FF::propSelected, undoMgr);
                 }
-                else {
-                    tree.setProperty (property, comboBox->getSelectedItemIndex (), undoMgr);
+                selectedChild = child;
+                if (selectedChild.isValid()) {
+                    selectedChild.setProperty (FF::propSelected, 1, undoMgr);
                 }
             }
-            updating = false;
         }
     }
 
     /** Updates the ComboBox property if the ValueTree has changed */
-    void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &changedProperty) override
-    {
-        if (! updating) {
-            updating = true;
-            if (selectSubNodes) {
-                if (treeWhosePropertyHasChanged.getParent() == tree) {
-                    if (changedProperty == property) {
-                        updateChoices();
-                    }
-                    else if (changedProperty == FF::propSelected) {
-                        for (int i=0; i < tree.getNumChildren(); ++i) {
-                            if (tree.getChild (i).hasProperty (FF::propSelected)
-                                && static_cast<int> (tree.getChild (i).getProperty (FF::propSelected)) > 0)
-                            {
-                                comboBox->setSelectedItemIndex (i);
-                            }
-                        }
-                    }
-                }
+    void routedPropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &changedProperty) override
+    {
+        const ValueTreeAttachmentStats::ScopedTimer timer (getBindingStats(), ValueTreeAttachmentStats::treeToComponent);
+        if (sync.isUpdating()) {
+            getBindingStats().count (ValueTreeAttachmentStats::suppressedEchoes);
+            return;
+        }
+        if (needsRebuild) {
+            // the pending rebuild reads all children anyway
+            return;
+        }
+        if (changedProperty == property) {
+            updateItemText (tree.indexOf (treeWhosePropertyHasChanged));
+        }
+        else if (changedProperty == FF::propSelected) {
+            if (isSelected (treeWhosePropertyHasChanged)) {
+                selectedChild = treeWhosePropertyHasChanged;
+                updateSelection (tree.indexOf (selectedChild));
             }
-            else {
-                if (treeWhosePropertyHasChanged == tree && changedProperty == property && comboBox) {
-                    if (tree.hasProperty (property)) {
-                        const int idx = tree.getProperty (property);
-                        comboBox->setSelectedItemIndex (idx);
-                    }
-                }
+            else if (treeWhosePropertyHasChanged == selectedChild) {
+                // the new selection usually follows, so the ComboBox is left as it is
+                selectedChild = juce::ValueTree();
             }
-            updating = false;
         }
     }
     
     /** If the ValueTree has new child nodes, they will be added as options in the ComboBox */
-    void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override
+    void routedChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override
     {
-        if (selectSubNodes) {
-            updateChoices ();
+        const int index = tree.indexOf (childWhichHasBeenAdded);
+        if (bulkEditDepth == 0 && comboBox && index == comboBox->getNumItems()) {
+            // appending needs no rebuild
+            comboBox->addItem (getItemText (childWhichHasBeenAdded), 100 + index);
+            if (isSelected (childWhichHasBeenAdded)) {
+                selectedChild = childWhichHasBeenAdded;
+                updateSelection (index);
+            }
+        }
+        else {
+            rebuildChoices();
         }
     }
     /** If child nodes were removed from the ValueTree, the options of the ComboBox are updated */
-    void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override
+    void routedChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override
     {
-        if (selectSubNodes) {
-            updateChoices ();
+        if (childWhichHasBeenRemoved == selectedChild) {
+            selectedChild = juce::ValueTree();
+        }
+        rebuildChoices();
+    }
+    /** If child nodes were moved, only the items between the old and new position are renamed */
+    void routedChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override
+    {
+        if (bulkEditDepth > 0) {
+            needsRebuild = true;
+            return;
+        }
+        for (int i = juce::jmin (oldIndex, newIndex); i <= juce::jmax (oldIndex, newIndex); ++i) {
+            updateItemText (i);
+        }
+        if (selectedChild.isValid()) {
+            updateSelection (tree.indexOf (selectedChild));
+        }
+    }
+
+    /**
+     Defers all updates of the choices until the matching endBulkEdit(). Use this
+     when adding, removing or moving many child nodes at once.
+     */
+    void beginBulkEdit ()
+    {
+        ++bulkEditDepth;
+    }
+
+    /** Ends a bulk edit and rebuilds the choices once, if the children have changed */
+    void endBulkEdit ()
+    {
+        jassert (bulkEditDepth > 0);
+        if (--bulkEditDepth == 0 && needsRebuild) {
+            updateChoices();
         }
     }
-    void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override {}
-    void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override {}
-    void valueTreeRedirected (juce::ValueTree &treeWhichHasBeenChanged) override {}
+
+    /** A batch of the router is a bulk edit of the children */
+    void routedBatchStarted () override
+    {
+        beginBulkEdit();
+    }
+
+    void routedBatchEnded () override
+    {
+        endBulkEdit();
+    }
 
 
 private:
@@ -189,20 +307,91 @@ private:
      */
     void updateChoices ()
     {
-        comboBox->clear();
+        if (! comboBox) {
+            return;
+        }
+        needsRebuild = false;
+        {
+            const ValueTreeAttachmentTypedSync<int>::ScopedUpdate scope (sync);
+            comboBox->clear (juce::dontSendNotification);
+            for (int i=0; i < tree.getNumChildren(); ++i) {
+                comboBox->addItem (getItemText (tree.getChild (i)), 100 + i);
+            }
+        }
+        // the cleared ComboBox lost its selection, so it has to be set in any case
+        sync.reset();
+        updateSelection (findSelectedChild());
+    }
+
+    /** Rebuilds the choices now or at the end of the bulk edit */
+    void rebuildChoices ()
+    {
+        if (bulkEditDepth > 0) {
+            needsRebuild = true;
+        }
+        else {
+            updateChoices();
+        }
+    }
+
+    /** Updates the text of a single item from its child node */
+    void updateItemText (int index)
+    {
+        if (comboBox && index >= 0 && index < comboBox->getNumItems()) {
+            const int itemId = 100 + index;
+            comboBox->changeItemText (itemId, getItemText (tree.getChild (index)));
+            if (comboBox->getSelectedId() == itemId) {
+                // refreshes the text shown for the selected item
+                const ValueTreeAttachmentTypedSync<int>::ScopedUpdate scope (sync);
+                comboBox->setSelectedId (itemId, juce::dontSendNotification);
+            }
+        }
+    }
+
+    juce::String getItemText (const juce::ValueTree& child) const
+    {
+        return child.getProperty (property, child.getType().toString());
+    }
+
+    /** Scans for the child node marked as selected, caches it and returns its index or -1 */
+    int findSelectedChild ()
+    {
+        int selected = -1;
+        selectedChild = juce::ValueTree();
         for (int i=0; i < tree.getNumChildren(); ++i) {
-            juce::ValueTree child = tree.getChild (i);
-            comboBox->addItem (child.getProperty (property, child.getType().toString()), 100 + i);
-            if (child.hasProperty (FF::propSelected) && static_cast<int> (child.getProperty (FF::propSelected)) != 0) {
-                comboBox->setSelectedId (100+i);
+            if (isSelected (tree.getChild (i))) {
+                selected = i;
+                selectedChild = tree.getChild (i);
             }
         }
+        return selected;
+    }
+
+    static bool isSelected (const juce::ValueTree& child)
+    {
+        return child.hasProperty (FF::propSelected) && static_cast<int> (child.getProperty (FF::propSelected)) > 0;
+    }
+
+    /** Selects the item idx, unless that is just the echo of the last change */
+    void updateSelection (int idx)
+    {
+        if (comboBox && sync.shouldUpdateComponent (idx)) {
+            getBindingStats().count (ValueTreeAttachmentStats::treeToComponentUpdates);
+            const ValueTreeAttachmentTypedSync<int>::ScopedUpdate scope (sync);
+            comboBox->setSelectedItemIndex (idx);
+            sync.componentUpdated (comboBox->getSelectedItemIndex());
+        }
     }
 
+    juce::SharedResourcePointer<ValueTreeAttachmentRouter> router;
     juce::ValueTree                                 tree;
     juce::Component::SafePointer<juce::ComboBox>    comboBox;
     juce::Identifier                                property;
     bool                                            selectSubNodes;
+    juce::ValueTree                                 selectedChild;
+    int                                             bulkEditDepth = 0;
+    bool                                            needsRebuild  = false;
     juce::UndoManager*                              undoMgr  = nullptr;
-    bool                                            updating = false;
+    ValueTreeAttachmentTypedSync<int>               sync;
+    std::unique_ptr<ValueTreeComboBoxIndexAttachment> indexAttachment;
 };
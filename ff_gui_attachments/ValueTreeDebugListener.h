@@ -44,17 +44,53 @@
 
 #pragma once
 
+#include <memory>
+#include <typeinfo>
+
 /**
  To debug the callbacks of a ValueTree::Listener simply attach a ValueTreeDebugListener to the tree and see 
  debug information in the console.
+
+ Building the debug strings is slow on a large tree. For a low overhead trace,
+ that can be left on, call setTracing (true): each callback then only writes a
+ binary record into a ValueTreeTraceBuffer, which is formatted when it is dumped.
+
+ To see which attachment callbacks a change triggers and how long each took,
+ call setProfiling (true) and write the result with exportChromeTrace(). The
+ file can be opened in Perfetto or chrome://tracing, nested callbacks show up
+ as nested slices.
+
+ dumpTree() writes the watched tree to an OutputStream while walking it, so
+ unlike toXmlString() no copy of the tree is built. It stops at a given depth,
+ can be restricted to some properties and can summarise the size of each subtree.
  */
-class ValueTreeDebugListener : public juce::ValueTree::Listener
+class ValueTreeDebugListener : public juce::ValueTree::Listener,
+                               private ValueTreeAttachmentRouter::Observer
 {
 public:
+    /**
+     Options for dumpTree()
+     */
+    struct DumpOptions
+    {
+        /** Levels of children to write, 0 writes the watched node only, -1 the whole tree */
+        int maxDepth = -1;
+
+        /** If not empty, only these properties are written */
+        juce::Array<juce::Identifier> properties;
+
+        /** Longer values are cut, so a huge string or blob can't flood the output */
+        int maxValueLength = 64;
+
+        /** Adds the number of nodes and properties and the approximate size to each node with children */
+        bool withSummary = false;
+    };
+
     /**
      Create a Debug listener to write callbacks to DBG.
      If you want to see callbacks from child trees too set @param includeChildren to true.
-     @param dumpTreeLevel is not yet implemented.
+     If @param dumpTreeLevel is greater than 0, the tree is dumped to DBG down to
+     that many levels of children when attaching, in debug builds only.
      */
     ValueTreeDebugListener (juce::ValueTree& treeToWatch, int shouldIncludeChildren=false, const int requestedDumpTreeLevel=0)
       : tree (treeToWatch),
@@ -65,16 +101,102 @@ public:
         jassert (tree.isValid());
         tree.addListener (this);
         DBG ("Debug listener attached to " + debugStringForTree (tree));
+#if JUCE_DEBUG
+        if (dumpTreeLevel > 0) {
+            DebugLineOutputStream dump;
+            DumpOptions options;
+            options.maxDepth = dumpTreeLevel;
+            dumpTree (dump, options);
+        }
+#endif
     }
 
     ~ValueTreeDebugListener ()
     {
+        setProfiling (false);
         tree.removeListener (this);
     }
 
+    /**
+     Switches between writing DBG strings and writing binary records into a trace
+     ring of \param capacity records. Switch it before the tree is used on other threads.
+     */
+    void setTracing (bool shouldTrace, int capacity = 65536)
+    {
+        if (shouldTrace && traceBuffer == nullptr) {
+            traceBuffer = std::make_unique<ValueTreeTraceBuffer> (capacity);
+        }
+        tracing = shouldTrace;
+    }
+
+    bool isTracing () const
+    {
+        return tracing;
+    }
+
+    /** Returns the trace ring, or nullptr if tracing was never switched on */
+    ValueTreeTraceBuffer* getTraceBuffer () const
+    {
+        return traceBuffer.get();
+    }
+
+    /**
+     Records the begin and end of every attachment callback of the shared router
+     into the trace ring, in addition to the tree callbacks. This switches tracing
+     on.
+     */
+    void setProfiling (bool shouldProfile)
+    {
+        if (shouldProfile) {
+            setTracing (true);
+            router->addObserver (this);
+        }
+        else {
+            router->removeObserver (this);
+        }
+        profiling = shouldProfile;
+    }
+
+    bool isProfiling () const
+    {
+        return profiling;
+    }
+
+    /** Writes the recorded trace as Chrome Trace Event JSON */
+    void exportChromeTrace (juce::OutputStream& out) const
+    {
+        if (traceBuffer != nullptr) {
+            traceBuffer->writeChromeTrace (out);
+        }
+    }
+
+    /**
+     Writes the watched tree in an XML like format. Each node is written as soon
+     as it is visited, the memory needed only grows with the depth.
+     */
+    void dumpTree (juce::OutputStream& out, const DumpOptions& options) const
+    {
+        dumpNode (out, tree, 0, options);
+    }
+
+    /** Writes the recorded trace formatted as text */
+    void dumpTrace (juce::OutputStream& out) const
+    {
+        if (traceBuffer != nullptr) {
+            traceBuffer->writeText (out);
+        }
+    }
+
     void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &property) override
     {
-        if (includeChildren || treeWhosePropertyHasChanged == tree) {
+        if (tracing) {
+            if (includeChildren || treeWhosePropertyHasChanged == tree) {
+                const juce::var* value = treeWhosePropertyHasChanged.getPropertyPointer (property);
+                traceBuffer->write (value != nullptr ? ValueTreeTraceBuffer::propertyChanged : ValueTreeTraceBuffer::propertyRemoved,
+                                    treeWhosePropertyHasChanged, property, value);
+            }
+        }
+        else if (includeChildren || treeWhosePropertyHasChanged == tree) {
             DBG (debugStringForTree (treeWhosePropertyHasChanged) + " property \"" + property.toString() + "\"" +
                  (treeWhosePropertyHasChanged.hasProperty(property) ?
                   " new value: " + treeWhosePropertyHasChanged.getProperty (property).toString() : " was removed" ));
@@ -83,14 +205,25 @@ public:
 
     void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override
     {
-        if (includeChildren || parentTree == tree) {
+        if (tracing) {
+            if (includeChildren || parentTree == tree) {
+                traceBuffer->write (ValueTreeTraceBuffer::childAdded, parentTree, childWhichHasBeenAdded.getType());
+            }
+        }
+        else if (includeChildren || parentTree == tree) {
             DBG (debugStringForTree (parentTree) + " has new child with type: " + childWhichHasBeenAdded.getType().toString());
         }
     }
 
     void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override
     {
-        if (includeChildren || parentTree == tree) {
+        if (tracing) {
+            if (includeChildren || parentTree == tree) {
+                traceBuffer->write (ValueTreeTraceBuffer::childRemoved, parentTree, childWhichHasBeenRemoved.getType(),
+                                    nullptr, indexFromWhichChildWasRemoved);
+            }
+        }
+        else if (includeChildren || parentTree == tree) {
             DBG (debugStringForTree(parentTree) + " lost child with type: " +
                  childWhichHasBeenRemoved.getType().toString() + " at index: " + juce::String (indexFromWhichChildWasRemoved));
         }
@@ -98,7 +231,13 @@ public:
 
     void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override
     {
-        if (includeChildren || parentTreeWhoseChildrenHaveMoved == tree) {
+        if (tracing) {
+            if (includeChildren || parentTreeWhoseChildrenHaveMoved == tree) {
+                traceBuffer->write (ValueTreeTraceBuffer::childOrderChanged, parentTreeWhoseChildrenHaveMoved, juce::Identifier(),
+                                    nullptr, oldIndex, newIndex);
+            }
+        }
+        else if (includeChildren || parentTreeWhoseChildrenHaveMoved == tree) {
             DBG (debugStringForTree (parentTreeWhoseChildrenHaveMoved) + " changed index from " +
                  juce::String (oldIndex) + " to new index " + juce::String (newIndex));
         }
@@ -106,20 +245,199 @@ public:
 
     void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override
     {
-        if (includeChildren || treeWhoseParentHasChanged == tree) {
+        if (tracing) {
+            if (includeChildren || treeWhoseParentHasChanged == tree) {
+                traceBuffer->write (ValueTreeTraceBuffer::parentChanged, treeWhoseParentHasChanged, juce::Identifier());
+            }
+        }
+        else if (includeChildren || treeWhoseParentHasChanged == tree) {
             DBG (debugStringForTree (treeWhoseParentHasChanged) + " parent changed");
         }
     }
 
     void valueTreeRedirected (juce::ValueTree &treeWhichHasBeenChanged) override
     {
-        if (includeChildren || treeWhichHasBeenChanged == tree) {
+        if (tracing) {
+            if (includeChildren || treeWhichHasBeenChanged == tree) {
+                traceBuffer->write (ValueTreeTraceBuffer::redirected, treeWhichHasBeenChanged, juce::Identifier());
+            }
+        }
+        else if (includeChildren || treeWhichHasBeenChanged == tree) {
             DBG (debugStringForTree (treeWhichHasBeenChanged) + " was redirected");
         }
     }
 
 private:
 
+    void targetCallbackStarted (ValueTreeAttachmentRouter::Target* target, const juce::ValueTree& node, const juce::Identifier& property) override
+    {
+        traceBuffer->writeCallback (ValueTreeTraceBuffer::callbackStarted, target, typeid (*target).name(), &node, property);
+    }
+
+    void targetCallbackFinished (ValueTreeAttachmentRouter::Target* target) override
+    {
+        // the target may be gone, so its type is not looked up here
+        traceBuffer->writeCallback (ValueTreeTraceBuffer::callbackFinished, target, nullptr, nullptr, juce::Identifier());
+    }
+
+    /** Number of nodes, properties and approximate bytes of a subtree */
+    struct Summary
+    {
+        juce::int64 nodes      = 0;
+        juce::int64 properties = 0;
+        juce::int64 bytes      = 0;
+
+        void add (const Summary& other)
+        {
+            nodes      += other.nodes;
+            properties += other.properties;
+            bytes      += other.bytes;
+        }
+    };
+
+    /** Writes node and its children down to the maximum depth and returns the summary of the subtree */
+    static Summary dumpNode (juce::OutputStream& out, const juce::ValueTree& node, int level, const DumpOptions& options)
+    {
+        Summary summary = options.withSummary ? summariseNode (node) : Summary();
+        out.writeRepeatedByte (' ', static_cast<size_t> (level * 2));
+        out << "<" << node.getType().toString();
+        for (int i=0; i < node.getNumProperties(); ++i) {
+            const juce::Identifier name = node.getPropertyName (i);
+            if (options.properties.isEmpty() || options.properties.contains (name)) {
+                out << " " << name.toString() << "=\"" << formatValue (node.getProperty (name), options.maxValueLength) << "\"";
+            }
+        }
+
+        const int numChildren = node.getNumChildren();
+        if (numChildren == 0) {
+            out << "/>\n";
+            return summary;
+        }
+        out << ">\n";
+
+        if (options.maxDepth < 0 || level < options.maxDepth) {
+            for (int i=0; i < numChildren; ++i) {
+                summary.add (dumpNode (out, node.getChild (i), level + 1, options));
+            }
+        }
+        else {
+            if (options.withSummary) {
+                for (int i=0; i < numChildren; ++i) {
+                    summary.add (summariseTree (node.getChild (i)));
+                }
+            }
+            out.writeRepeatedByte (' ', static_cast<size_t> (level * 2 + 2));
+            out << "<!-- " << juce::String (numChildren) << " children not shown -->\n";
+        }
+
+        if (options.withSummary) {
+            out.writeRepeatedByte (' ', static_cast<size_t> (level * 2 + 2));
+            out << "<!-- " << juce::String (summary.nodes) << " nodes, " << juce::String (summary.properties)
+                << " properties, " << juce::File::descriptionOfSizeInBytes (summary.bytes) << " -->\n";
+        }
+        out.writeRepeatedByte (' ', static_cast<size_t> (level * 2));
+        out << "</" << node.getType().toString() << ">\n";
+        return summary;
+    }
+
+    static Summary summariseNode (const juce::ValueTree& node)
+    {
+        Summary summary;
+        summary.nodes      = 1;
+        summary.properties = node.getNumProperties();
+        for (int i=0; i < node.getNumProperties(); ++i) {
+            const juce::var& value = node.getProperty (node.getPropertyName (i));
+            if (const auto* block = value.getBinaryData()) {
+                summary.bytes += static_cast<juce::int64> (block->getSize());
+            }
+            else if (value.isString()) {
+                summary.bytes += static_cast<juce::int64> (value.toString().getNumBytesAsUTF8());
+            }
+            else {
+                summary.bytes += static_cast<juce::int64> (sizeof (double));
+            }
+        }
+        return summary;
+    }
+
+    /** Counts a subtree without writing it */
+    static Summary summariseTree (const juce::ValueTree& node)
+    {
+        Summary summary = summariseNode (node);
+        for (int i=0; i < node.getNumChildren(); ++i) {
+            summary.add (summariseTree (node.getChild (i)));
+        }
+        return summary;
+    }
+
+    /** Formats a value escaped for an attribute, cut to maxLength characters */
+    static juce::String formatValue (const juce::var& value, int maxLength)
+    {
+        if (const auto* block = value.getBinaryData()) {
+            return "[" + juce::File::descriptionOfSizeInBytes (static_cast<juce::int64> (block->getSize())) + " binary]";
+        }
+        juce::String text = value.toString();
+        if (maxLength > 0 && text.length() > maxLength) {
+            text = text.substring (0, maxLength) + "...";
+        }
+        return text.replace ("&", "&amp;").replace ("\"", "&quot;").replace ("<", "&lt;").replace ("\n", "&#10;");
+    }
+
+#if JUCE_DEBUG
+    /** Passes the text written to it to DBG line by line, so a large dump is never held as a whole */
+    class DebugLineOutputStream : public juce::OutputStream
+    {
+    public:
+        ~DebugLineOutputStream () override
+        {
+            flush();
+        }
+
+        void flush () override
+        {
+            if (line.getDataSize() > 0) {
+                writeLine();
+            }
+        }
+
+        bool setPosition (juce::int64) override
+        {
+            return false;
+        }
+
+        juce::int64 getPosition () override
+        {
+            return position;
+        }
+
+        bool write (const void* dataToWrite, size_t numberOfBytes) override
+        {
+            const char* start = static_cast<const char*> (dataToWrite);
+            const char* end   = start + numberOfBytes;
+            for (const char* c = start; c != end; ++c) {
+                if (*c == '\n') {
+                    line.write (start, static_cast<size_t> (c - start));
+                    writeLine();
+                    start = c + 1;
+                }
+            }
+            line.write (start, static_cast<size_t> (end - start));
+            position += static_cast<juce::int64> (numberOfBytes);
+            return true;
+        }
+
+    private:
+        void writeLine ()
+        {
+            DBG (line.toString());
+            line.reset();
+        }
+
+        juce::MemoryOutputStream line;
+        juce::int64              position = 0;
+    };
+#endif
+
     /** returns a descriptive string for _tree */
     juce::String debugStringForTree (juce::ValueTree& debuggedTree) const
     {
@@ -137,19 +455,17 @@ private:
         }
     }
 
-    /** returns the level from _tree to watched tree */
+    /** returns the level from _tree to watched tree, walking the parents only once */
     int getChildOrder (juce::ValueTree& debuggedTree) const
     {
-        if (debuggedTree.isAChildOf(tree)) {
-            int level = 0;
-            juce::ValueTree seeker = debuggedTree;
-            while (seeker.isValid()) {
-                if (seeker == tree) {
-                    return level;
-                }
-                seeker = seeker.getParent();
-                ++level;
+        int level = 0;
+        juce::ValueTree seeker = debuggedTree;
+        while (seeker.isValid()) {
+            if (seeker == tree) {
+                return level;
             }
+            seeker = seeker.getParent();
+            ++level;
         }
         return -1;
     }
@@ -157,4 +473,8 @@ private:
     juce::ValueTree tree;
     bool            includeChildren;
     int             dumpTreeLevel;
+    bool            tracing   = false;
+    bool            profiling = false;
+    std::unique_ptr<ValueTreeTraceBuffer> traceBuffer;
+    juce::SharedResourcePointer<ValueTreeAttachmentRouter> router;
 };
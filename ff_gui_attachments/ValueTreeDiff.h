@@ -0,0 +1,352 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeDiff.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+/**
+ \class ValueTreeDiff
+ \brief Computes the minimal changes to turn a ValueTree into another one
+
+ Instead of replacing a subtree or copying all properties, e.g. when a preset is
+ loaded, the ValueTreeDiff compares the live tree with the target tree and
+ collects only the properties that differ and the child nodes to add, remove or
+ move. Applying it touches only the attachments whose values actually change.
+
+ Child nodes are matched by their type and the value of the key property. If no
+ key property is given or a child doesn't have it, the children of the same type
+ are matched in their order. Matched children keep their longest run in the
+ right order, only the others are moved.
+
+ \code{.cpp}
+    ValueTreeDiff::applyPreset (state, presetB, &undoManager, "id");
+ \endcode
+ */
+class ValueTreeDiff
+{
+public:
+    /**
+     One change to the live tree. The operations refer to the nodes of the live
+     tree and have to be applied in their order.
+     */
+    struct Operation
+    {
+        enum Type
+        {
+            setProperty = 0,
+            removeProperty,
+            addChild,
+            removeChild,
+            moveChild
+        };
+
+        Operation (Type typeOfChange, const juce::ValueTree& nodeToChange)
+          : type (typeOfChange),
+            node (nodeToChange)
+        {
+        }
+
+        Type             type;
+        juce::ValueTree  node;          ///< the node whose property or children are changed
+        juce::Identifier property;      ///< for setProperty and removeProperty
+        juce::var        value;         ///< for setProperty
+        juce::ValueTree  child;         ///< for addChild, a copy of the target's child
+        int              index    = -1; ///< for addChild and removeChild, the source index for moveChild
+        int              newIndex = -1; ///< for moveChild
+    };
+
+    /**
+     Compares \param liveTree with \param targetTree. The children are matched by
+     the \param keyProperty, if given.
+     */
+    ValueTreeDiff (const juce::ValueTree& liveTree,
+                   const juce::ValueTree& targetTree,
+                   const juce::Identifier& keyProperty = juce::Identifier())
+    :   liveRoot (liveTree),
+        key (keyProperty)
+    {
+        // the root nodes have to describe the same thing
+        jassert (liveTree.getType() == targetTree.getType());
+        compareNodes (liveTree, targetTree);
+    }
+
+    /** Returns the operations in the order they have to be applied */
+    const std::vector<Operation>& getOperations () const
+    {
+        return operations;
+    }
+
+    int getNumOperations () const
+    {
+        return static_cast<int> (operations.size());
+    }
+
+    bool isEmpty () const
+    {
+        return operations.empty();
+    }
+
+    /**
+     Applies all operations to the live tree. This is done within a
+     ScopedAttachmentBatch, so each attachment is updated only once, and with an
+     UndoManager all changes form one undoable transaction.
+     A diff can only be applied once, the added children would be added again.
+     */
+    void apply (juce::UndoManager* undoManager = nullptr,
+                const juce::String& transactionName = juce::String())
+    {
+        // the diff was applied already, create a new one for the changed tree
+        jassert (! applied);
+        if (applied || operations.empty()) {
+            return;
+        }
+        applied = true;
+        const ScopedAttachmentBatch batch (liveRoot, undoManager, transactionName);
+        for (const auto& op : operations) {
+            juce::ValueTree node = op.node;
+            switch (op.type) {
+                case Operation::setProperty:    node.setProperty (op.property, op.value, undoManager); break;
+                case Operation::removeProperty: node.removeProperty (op.property, undoManager); break;
+                case Operation::addChild:       node.addChild (op.child, op.index, undoManager); break;
+                case Operation::removeChild:    node.removeChild (op.index, undoManager); break;
+                case Operation::moveChild:      node.moveChild (op.index, op.newIndex, undoManager); break;
+                default: jassertfalse; break;
+            }
+        }
+    }
+
+    /**
+     Convenience method to turn \param liveTree into \param targetTree with the
+     minimal number of changes. Returns the number of applied operations.
+     */
+    static int applyPreset (juce::ValueTree& liveTree,
+                            const juce::ValueTree& targetTree,
+                            juce::UndoManager* undoManager = nullptr,
+                            const juce::Identifier& keyProperty = juce::Identifier())
+    {
+        ValueTreeDiff diff (liveTree, targetTree, keyProperty);
+        diff.apply (undoManager, "Apply preset");
+        return diff.getNumOperations();
+    }
+
+private:
+    struct StringHash
+    {
+        size_t operator() (const juce::String& s) const noexcept
+        {
+            return static_cast<size_t> (s.hashCode64());
+        }
+    };
+
+    void compareNodes (const juce::ValueTree& live, const juce::ValueTree& target)
+    {
+        compareProperties (live, target);
+        compareChildren (live, target);
+    }
+
+    void compareProperties (const juce::ValueTree& live, const juce::ValueTree& target)
+    {
+        for (int i=0; i < target.getNumProperties(); ++i) {
+            const juce::Identifier name = target.getPropertyName (i);
+            const juce::var& value = target.getProperty (name);
+            // a missing property compares equal to 0 or "", and "1" equals 1, so the type counts too
+            if (! live.hasProperty (name) || ! live.getProperty (name).equalsWithSameType (value)) {
+                Operation op { Operation::setProperty, live };
+                op.property = name;
+                op.value    = value;
+                operations.push_back (op);
+            }
+        }
+        for (int i=0; i < live.getNumProperties(); ++i) {
+            const juce::Identifier name = live.getPropertyName (i);
+            if (! target.hasProperty (name)) {
+                Operation op { Operation::removeProperty, live };
+                op.property = name;
+                operations.push_back (op);
+            }
+        }
+    }
+
+    void compareChildren (const juce::ValueTree& live, const juce::ValueTree& target)
+    {
+        const int numLive   = live.getNumChildren();
+        const int numTarget = target.getNumChildren();
+        if (numLive == 0 && numTarget == 0) {
+            return;
+        }
+
+        // match the live children to the target children
+        std::unordered_map<juce::String, int, StringHash> liveByKey;
+        liveByKey.reserve (static_cast<size_t> (numLive));
+        {
+            std::unordered_map<juce::String, int, StringHash> occurrences;
+            for (int i=0; i < numLive; ++i) {
+                liveByKey.emplace (getMatchKey (live.getChild (i), occurrences), i);
+            }
+        }
+        std::vector<int> matched (static_cast<size_t> (numTarget), -1);
+        std::vector<bool> isMatched (static_cast<size_t> (numLive), false);
+        {
+            std::unordered_map<juce::String, int, StringHash> occurrences;
+            for (int i=0; i < numTarget; ++i) {
+                auto entry = liveByKey.find (getMatchKey (target.getChild (i), occurrences));
+                if (entry != liveByKey.end() && ! isMatched [static_cast<size_t> (entry->second)]) {
+                    matched [static_cast<size_t> (i)] = entry->second;
+                    isMatched [static_cast<size_t> (entry->second)] = true;
+                }
+            }
+        }
+
+        // the order of the children is simulated, so the indices stay valid
+        juce::Array<juce::ValueTree> order;
+        order.ensureStorageAllocated (numTarget);
+        for (int i=numLive - 1; i >= 0; --i) {
+            if (! isMatched [static_cast<size_t> (i)]) {
+                Operation op { Operation::removeChild, live };
+                op.index = i;
+                operations.push_back (op);
+            }
+        }
+        for (int i=0; i < numLive; ++i) {
+            if (isMatched [static_cast<size_t> (i)]) {
+                order.add (live.getChild (i));
+            }
+        }
+
+        std::vector<juce::ValueTree> placed (static_cast<size_t> (numTarget));
+        for (int i=0; i < numTarget; ++i) {
+            if (matched [static_cast<size_t> (i)] >= 0) {
+                placed [static_cast<size_t> (i)] = live.getChild (matched [static_cast<size_t> (i)]);
+            }
+        }
+
+        // the matched children in a longest increasing order stay where they are
+        const std::vector<bool> stays = findLongestIncreasingRun (matched);
+
+        // every other child is placed right behind its predecessor in the target
+        for (int i=0; i < numTarget; ++i) {
+            if (stays [static_cast<size_t> (i)]) {
+                continue;
+            }
+            const int position = i == 0 ? 0 : order.indexOf (placed [static_cast<size_t> (i - 1)]) + 1;
+            if (matched [static_cast<size_t> (i)] < 0) {
+                Operation op { Operation::addChild, live };
+                op.child = target.getChild (i).createCopy();
+                op.index = position;
+                order.insert (position, op.child);
+                placed [static_cast<size_t> (i)] = op.child;
+                operations.push_back (op);
+            }
+            else {
+                const int current = order.indexOf (placed [static_cast<size_t> (i)]);
+                const int destination = current < position ? position - 1 : position;
+                if (current != destination) {
+                    Operation op { Operation::moveChild, live };
+                    op.index    = current;
+                    op.newIndex = destination;
+                    order.move (current, destination);
+                    operations.push_back (op);
+                }
+            }
+        }
+
+        for (int i=0; i < numTarget; ++i) {
+            const int liveIndex = matched [static_cast<size_t> (i)];
+            if (liveIndex >= 0) {
+                compareNodes (live.getChild (liveIndex), target.getChild (i));
+            }
+        }
+    }
+
+    /** Creates the key to match children, e.g. "Option/osc1" or "Option#2" */
+    juce::String getMatchKey (const juce::ValueTree& child,
+                              std::unordered_map<juce::String, int, StringHash>& occurrences) const
+    {
+        const juce::String type = child.getType().toString();
+        if (key.isValid() && child.hasProperty (key)) {
+            return type + "/" + child.getProperty (key).toString();
+        }
+        return type + "#" + juce::String (occurrences [type]++);
+    }
+
+    /**
+     Marks the target children, whose matched live indices form the longest
+     increasing sequence. Unmatched children are never part of it.
+     */
+    static std::vector<bool> findLongestIncreasingRun (const std::vector<int>& matched)
+    {
+        const size_t num = matched.size();
+        std::vector<bool> stays (num, false);
+        std::vector<size_t> tails;              // index of the smallest tail of each length
+        std::vector<size_t> previous (num, num);
+        for (size_t i=0; i < num; ++i) {
+            if (matched [i] < 0) {
+                continue;
+            }
+            auto pos = std::lower_bound (tails.begin(), tails.end(), matched [i],
+                                         [&matched] (size_t t, int value) { return matched [t] < value; });
+            if (pos != tails.begin()) {
+                previous [i] = *(pos - 1);
+            }
+            if (pos == tails.end()) {
+                tails.push_back (i);
+            }
+            else {
+                *pos = i;
+            }
+        }
+        for (size_t i = tails.empty() ? num : tails.back(); i < num; i = previous [i]) {
+            stays [i] = true;
+        }
+        return stays;
+    }
+
+    juce::ValueTree        liveRoot;
+    juce::Identifier       key;
+    std::vector<Operation> operations;
+    bool                   applied = false;
+};
@@ -46,12 +46,31 @@
 
 #include "../JuceLibraryCode/JuceHeader.h"
 
+/** Binds the text of a Label, see ValueTreeAttachment */
+struct ValueTreeLabelTraits
+{
+    using ValueType = juce::String;
+
+    static ValueType getValue (const juce::Label& label)
+    {
+        return label.getText();
+    }
+
+    static void setValue (juce::Label& label, const ValueType& text, juce::NotificationType notification)
+    {
+        label.setText (text, notification);
+    }
+
+    static constexpr juce::NotificationType initialNotification = juce::dontSendNotification;
+    static constexpr juce::NotificationType updateNotification  = juce::dontSendNotification;
+};
+
 /**
  \class ValueTreeLabelAttachment
  \brief Connects a Label to a ValueTree node to synchronise
  */
-class ValueTreeLabelAttachment : public juce::Label::Listener,
-                                public juce::ValueTree::Listener
+class ValueTreeLabelAttachment : public ValueTreeAttachment<juce::Label, ValueTreeLabelTraits>,
+                                 public juce::Label::Listener
 {
 public:
     /**
@@ -62,31 +81,15 @@ public:
                                juce::Label* attachToLabel,
                                juce::Identifier textProperty,
                                juce::UndoManager* undoManagerToUse = nullptr)
-    :   tree (attachToTree),
-        property (textProperty),
-        undoMgr (undoManagerToUse),
-        updating (false)
+    :   ValueTreeAttachment (attachToTree, attachToLabel, std::move (textProperty), undoManagerToUse)
     {
-        // Don't attach an invalid valuetree!
-        jassert (tree.isValid());
-        label = attachToLabel;
-
-        if (tree.hasProperty (property)) {
-            label->setText (tree.getProperty(property), juce::dontSendNotification);
-        }
-        else {
-            tree.setProperty (property, label->getText(), undoMgr);
-        }
-
-        tree.addListener (this);
-        label->addListener (this);
+        attachToLabel->addListener (this);
     }
 
-    ~ValueTreeLabelAttachment ()
+    ~ValueTreeLabelAttachment () override
     {
-        tree.removeListener (this);
-        if (label) {
-            label->removeListener (this);
+        if (component) {
+            component->removeListener (this);
         }
     }
 
@@ -95,43 +98,8 @@ public:
      */
     void labelTextChanged (juce::Label *_label) override
     {
-        if (! updating) {
-            updating = true;
-            if (label == _label) {
-                tree.setProperty (property, label->getText(), undoMgr);
-            }
-            updating = false;
-        }
-    }
-
-    /**
-     This updates the Label to display the ValueTree's property
-     */
-    void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &_property) override
-    {
-        if (! updating) {
-            updating = true;
-            if (treeWhosePropertyHasChanged == tree && label) {
-                if (_property == property) {
-                    label->setText(tree.getProperty (property), juce::dontSendNotification);
-                }
-            }
-
-            updating = false;
+        if (component == _label) {
+            writeToTree();
         }
     }
-    
-    void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override {}
-    void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override {}
-    void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override {}
-    void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override {}
-    void valueTreeRedirected (juce::ValueTree &treeWhichHasBeenChanged) override {}
-
-private:
-    juce::ValueTree                             tree;
-    juce::Component::SafePointer<juce::Label>   label;
-    juce::Identifier                            property;
-    juce::UndoManager*                          undoMgr  = nullptr;
-    bool                                        updating = false;
 };
-
@@ -0,0 +1,173 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeParameterBlock.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+/**
+ \class ValueTreeParameterBlock
+ \brief A lock free mirror of attached values for the audio thread
+
+ Reading a juce::var from a ValueTree on the audio thread locks, allocates and
+ races with the message thread. Instead an attachment can publish its value into
+ a slot of a ValueTreeParameterBlock, whenever it syncs the component with the
+ tree. The audio thread reads the slots lock free without any var conversion.
+
+ The slots are allocated once with a fixed capacity and packed contiguously in
+ cache lines. Add all slots on the message thread, before the audio thread
+ starts reading.
+
+ \code{.cpp}
+    // message thread
+    const int gainSlot = parameters.addSlot ("gain");
+    gainAttachment.setParameterBlock (&parameters, gainSlot);
+
+    // audio thread
+    buffer.applyGain (parameters.getFloat (gainSlot));
+ \endcode
+ */
+class ValueTreeParameterBlock
+{
+public:
+    explicit ValueTreeParameterBlock (int maximumNumSlots = 512)
+    :   capacity (maximumNumSlots),
+        lines (new CacheLine [static_cast<size_t> ((maximumNumSlots + slotsPerLine - 1) / slotsPerLine)])
+    {
+        jassert (maximumNumSlots > 0);
+        names.ensureStorageAllocated (capacity);
+    }
+
+    /**
+     Adds a slot for the value named \param name and returns its index. If the
+     name already has a slot, that index is returned. Returns -1 if the block is full.
+     Call this only on the message thread.
+     */
+    int addSlot (const juce::Identifier& name, float initialValue = 0.0f)
+    {
+        const int existing = names.indexOf (name);
+        if (existing >= 0) {
+            return existing;
+        }
+        // create the block with a larger capacity
+        jassert (names.size() < capacity);
+        if (names.size() >= capacity) {
+            return -1;
+        }
+        names.add (name);
+        const int index = names.size() - 1;
+        set (index, initialValue);
+        return index;
+    }
+
+    /** Returns the index of the slot named \param name or -1 */
+    int indexOf (const juce::Identifier& name) const
+    {
+        return names.indexOf (name);
+    }
+
+    juce::Identifier getSlotName (int index) const
+    {
+        return names [index];
+    }
+
+    /** Writes a value to a slot. This is called by the attachments on the message thread. */
+    void set (int index, float value) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (index, capacity));
+        Slot& slot = getSlot (index);
+        slot.floatValue.store (value, std::memory_order_relaxed);
+        slot.intValue.store (juce::roundToInt (value), std::memory_order_relaxed);
+    }
+
+    /** Reads a slot as float, safe to call on the audio thread */
+    float getFloat (int index) const noexcept
+    {
+        jassert (juce::isPositiveAndBelow (index, capacity));
+        return getSlot (index).floatValue.load (std::memory_order_relaxed);
+    }
+
+    /** Reads a slot as int, e.g. for choices and toggles, safe to call on the audio thread */
+    int getInt (int index) const noexcept
+    {
+        jassert (juce::isPositiveAndBelow (index, capacity));
+        return getSlot (index).intValue.load (std::memory_order_relaxed);
+    }
+
+    int getNumSlots () const
+    {
+        return names.size();
+    }
+
+    int getCapacity () const noexcept
+    {
+        return capacity;
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<float> floatValue { 0.0f };
+        std::atomic<int>   intValue   { 0 };
+    };
+
+    enum { cacheLineSize = 64, slotsPerLine = cacheLineSize / sizeof (Slot) };
+
+    struct alignas (cacheLineSize) CacheLine
+    {
+        Slot slots [slotsPerLine];
+    };
+
+    Slot& getSlot (int index) const noexcept
+    {
+        return lines [static_cast<size_t> (index / slotsPerLine)].slots [index % slotsPerLine];
+    }
+
+    const int                     capacity;
+    std::unique_ptr<CacheLine[]>  lines;
+    juce::Array<juce::Identifier> names;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeParameterBlock)
+};
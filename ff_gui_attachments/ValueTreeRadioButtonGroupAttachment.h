@@ -44,6 +44,9 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <unordered_set>
+
 /**
  \class ValueTreeRadioButtonGroupAttachment
  \brief The ValueTreeRadioButtonGroupAttachment keeps a radio button group in sync
@@ -52,9 +55,14 @@
  If selectSubNodes is set to true, for the selected radio button, a property 
  selected is set to 1 in the node having the same componentID as the given 
  property in the attachment.
+
+ Buttons and child nodes are looked up by componentID in hash maps, which are
+ kept up to date when child nodes are added, removed or renamed. A renamed child
+ only moves its own entry.
  */
-class ValueTreeRadioButtonGroupAttachment : public juce::ValueTree::Listener,
-                                            public juce::Button::Listener
+class ValueTreeRadioButtonGroupAttachment : public ValueTreeAttachmentRouter::Target,
+                                            public juce::Button::Listener,
+                                            private ValueTreeAttachmentStats::Binding
 {
 public:
     /**
@@ -68,52 +76,79 @@ public:
                                          juce::Identifier indexProperty,
                                          bool shouldSelectSubNodes,
                                          juce::UndoManager* undoManagerToUse = nullptr)
-    :   tree (attachToTree),
+    :   ValueTreeAttachmentStats::Binding (indexProperty, nullptr),
+        tree (attachToTree),
         property (indexProperty),
         selectSubNodes (shouldSelectSubNodes),
-        undoMgr (undoManagerToUse),
-        updating (false)
+        undoMgr (undoManagerToUse)
     {
-
+        std::unordered_set<juce::Button*> added;
         for (int i=0; i < _buttons.size(); ++i) {
             juce::Button* b = _buttons.getUnchecked (i);
-            if (! buttons.contains (b)) {
+            if (added.insert (b).second) {
                 buttons.add (b);
+                buttonsById.emplace (b->getComponentID(), b);
                 b->addListener (this);
             }
         }
 
-        if (tree.getNumChildren() < 1) {
+        const bool createOptions = tree.getNumChildren() < 1;
+        if (createOptions) {
             for (int i=0; i < buttons.size(); ++i) {
                 juce::Button* b = buttons.getUnchecked (i);
                 juce::ValueTree child = juce::ValueTree ("option");
                 child.setProperty (property, b->getComponentID(), undoMgr);
+                // the new options start with the selection the buttons show
+                if (selectSubNodes && b->getToggleState() && ! selectedChild.isValid()) {
+                    child.setProperty (FF::propSelected, 1, undoMgr);
+                    selectedChild = child;
+                }
                 tree.addChild (child, -1, undoMgr);
             }
         }
-        else {
-            for (int i=0; i < buttons.size(); ++i) {
-                juce::Button* b = buttons.getUnchecked (i);
-                for (int k=0; k < tree.getNumChildren(); ++k) {
-                    juce::ValueTree child = tree.getChild (k);
-                    if (child.hasProperty (property) && child.getProperty (property) == b->getComponentID()) {
-                        if (child.hasProperty (FF::propSelected) && static_cast<int> (child.getProperty (FF::propSelected)) != 0) {
-                            b->setToggleState (true, juce::dontSendNotification);
-                        }
-                        else {
-                            b->setToggleState (false, juce::dontSendNotification);
-                        }
+        buildChildIndex();
+
+        if (! createOptions) {
+            // walked in child order, so if several children are selected, the last one wins
+            juce::String selectedId;
+            for (int i=0; i < tree.getNumChildren(); ++i) {
+                juce::ValueTree child = tree.getChild (i);
+                if (isSelected (child) && findButton (child.getProperty (property).toString()) != nullptr) {
+                    selectedChild = child;
+                    selectedId    = child.getProperty (property).toString();
+                }
+            }
+            // without a selected child the buttons keep their state
+            if (selectedChild.isValid()) {
+                for (auto& b : buttons) {
+                    if (b != nullptr) {
+                        b->setToggleState (b->getComponentID() == selectedId, juce::dontSendNotification);
                     }
                 }
             }
         }
+        recordToggledButton();
 
-        tree.addListener (this);
+        if (selectSubNodes) {
+            router->addChildPropertyTarget (tree, FF::propSelected, this);
+            router->addChildPropertyTarget (tree, property, this);
+            router->addChildrenTarget (tree, this);
+        }
+        else {
+            router->addPropertyTarget (tree, property, this);
+        }
     }
 
     ~ValueTreeRadioButtonGroupAttachment ()
     {
-        tree.removeListener (this);
+        if (selectSubNodes) {
+            router->removeChildPropertyTarget (tree, FF::propSelected, this);
+            router->removeChildPropertyTarget (tree, property, this);
+            router->removeChildrenTarget (tree, this);
+        }
+        else {
+            router->removePropertyTarget (tree, property, this);
+        }
         for (auto b : buttons) {
             if (b) {
                 b->removeListener (this);
@@ -123,72 +158,186 @@ public:
 
     void buttonClicked (juce::Button*) override {}
 
+    /**
+     JUCE calls this on every hover and mouse press as well, so only a transition
+     of the toggle state is turned into a write to the tree.
+     */
     void buttonStateChanged (juce::Button *buttonThatHasChanged) override
     {
-        if (selectSubNodes) {
-            if (buttonThatHasChanged->getToggleState()) {
-                for (int i=0; i < tree.getNumChildren(); ++i) {
-                    juce::ValueTree child = tree.getChild (i);
-                    if (child.hasProperty (property)) {
-                        if (child.getProperty (property) == buttonThatHasChanged->getComponentID()) {
-                            child.setProperty (FF::propSelected, 1, undoMgr);
-                        }
-                        else {
-                            child.removeProperty (FF::propSelected, undoMgr);
-                        }
-                    }
+        const bool isOn = buttonThatHasChanged->getToggleState();
+        if (isOn == (buttonThatHasChanged == toggledButton)) {
+            return;
+        }
+        toggledButton = isOn ? buttonThatHasChanged : nullptr;
+
+        if (selectSubNodes && isOn) {
+            const ValueTreeAttachmentStats::ScopedTimer timer (getBindingStats(), ValueTreeAttachmentStats::componentToTree);
+            if (! sync.shouldWriteToTree (buttonThatHasChanged->getComponentID())) {
+                getBindingStats().count (sync.isUpdating() ? ValueTreeAttachmentStats::suppressedEchoes
+                                                      : ValueTreeAttachmentStats::unchangedWrites);
+            }
+            else {
+                getBindingStats().count (ValueTreeAttachmentStats::componentToTreeWrites);
+                const ValueTreeAttachmentTypedSync<juce::String>::ScopedUpdate scope (sync);
+                // only the previous and the new selection are touched
+                juce::ValueTree child = findChild (buttonThatHasChanged->getComponentID());
+                if (selectedChild.isValid() && selectedChild != child) {
+                    selectedChild.removeProperty (FF::propSelected, undoMgr);
+                }
+                selectedChild = child;
+                if (selectedChild.isValid()) {
+                    selectedChild.setProperty (FF::propSelected, 1, undoMgr);
                 }
             }
         }
 
     }
 
-    void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &_property) override
-    {
-        if (! updating) {
-            updating = true;
-            if (selectSubNodes) {
-                if (treeWhosePropertyHasChanged.getParent() == tree
-                    && _property == juce::Identifier (FF::propSelected))
-                {
-                    if (treeWhosePropertyHasChanged.hasProperty (FF::propSelected)) {
-                        juce::String selected = treeWhosePropertyHasChanged.getProperty (property);
-                        for (int i=0; i < buttons.size(); ++i) {
-                            juce::Component::SafePointer<juce::Button> b = buttons.getUnchecked (i);
-                            if (b->getComponentID() == selected) {
-                                b->setToggleState (true, juce::sendNotification);
-                            }
-                        }
-                    }
+    void routedPropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &_property) override
+    {
+        const ValueTreeAttachmentStats::ScopedTimer timer (getBindingStats(), ValueTreeAttachmentStats::treeToComponent);
+        if (selectSubNodes) {
+            if (_property == FF::propSelected) {
+                if (isSelected (treeWhosePropertyHasChanged)) {
+                    selectedChild = treeWhosePropertyHasChanged;
+                    updateButtons (treeWhosePropertyHasChanged.getProperty (property).toString());
+                }
+                else if (treeWhosePropertyHasChanged == selectedChild) {
+                    selectedChild = juce::ValueTree();
                 }
             }
             else {
-                if (treeWhosePropertyHasChanged == tree && _property == property) {
-                    juce::String selected = tree.getProperty (property, "");
-                    for (int i=0; i < buttons.size(); ++i) {
-                        juce::Component::SafePointer<juce::Button> b = buttons.getUnchecked (i);
-                        if (b->getComponentID() == selected) {
-                            b->setToggleState (true, juce::sendNotification);
-                        }
-                    }
-                }
+                // a child changed its componentID, only its own entry is moved
+                removeFromChildIndex (treeWhosePropertyHasChanged);
+                addToChildIndex (treeWhosePropertyHasChanged);
             }
-            updating = false;
         }
+        else {
+            updateButtons (tree.getProperty (property).toString());
+        }
+    }
+
+    void routedChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override
+    {
+        addToChildIndex (childWhichHasBeenAdded);
     }
 
-    void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override {}
-    void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override {}
-    void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override {}
-    void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override {}
-    void valueTreeRedirected (juce::ValueTree &treeWhichHasBeenChanged) override {}
+    void routedChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override
+    {
+        removeFromChildIndex (childWhichHasBeenRemoved);
+        if (childWhichHasBeenRemoved == selectedChild) {
+            selectedChild = juce::ValueTree();
+        }
+    }
 
 private:
+    struct StringHash
+    {
+        size_t operator() (const juce::String& s) const noexcept
+        {
+            return static_cast<size_t> (s.hashCode64());
+        }
+    };
+
+    /** Toggles the button with the componentID selected */
+    void updateButtons (const juce::String& selected)
+    {
+        if (! sync.shouldUpdateComponent (selected)) {
+            getBindingStats().count (ValueTreeAttachmentStats::suppressedEchoes);
+        }
+        else {
+            getBindingStats().count (ValueTreeAttachmentStats::treeToComponentUpdates);
+            const ValueTreeAttachmentTypedSync<juce::String>::ScopedUpdate scope (sync);
+            if (auto* b = findButton (selected)) {
+                b->setToggleState (true, juce::sendNotification);
+                toggledButton = b;
+            }
+            sync.componentUpdated (selected);
+        }
+    }
+
+    /**
+     Remembers the button that is on, so that hovering or pressing it isn't taken
+     for a new selection
+     */
+    void recordToggledButton ()
+    {
+        for (auto& b : buttons) {
+            if (b != nullptr && b->getToggleState()) {
+                toggledButton = b;
+                sync.shouldUpdateComponent (b->getComponentID());
+                sync.componentUpdated (b->getComponentID());
+                return;
+            }
+        }
+    }
+
+    /** Builds the maps between componentID and child node */
+    void buildChildIndex ()
+    {
+        childrenById.reserve (static_cast<size_t> (tree.getNumChildren()));
+        idsByChild.reserve (static_cast<size_t> (tree.getNumChildren()));
+        for (int i=0; i < tree.getNumChildren(); ++i) {
+            addToChildIndex (tree.getChild (i));
+        }
+    }
+
+    void addToChildIndex (const juce::ValueTree& child)
+    {
+        if (child.hasProperty (property)) {
+            const juce::String componentID = child.getProperty (property).toString();
+            // if several children share an id, the first one is kept
+            if (childrenById.emplace (componentID, child).second) {
+                idsByChild [getChildKey (child)] = componentID;
+            }
+        }
+    }
+
+    /** Removes the child with the id it was indexed with, which may differ from its current one */
+    void removeFromChildIndex (const juce::ValueTree& child)
+    {
+        auto id = idsByChild.find (getChildKey (child));
+        if (id == idsByChild.end()) {
+            return;
+        }
+        childrenById.erase (id->second);
+        idsByChild.erase (id);
+    }
+
+    /** The property set is shared by all copies of a node, so its address identifies the child */
+    static const void* getChildKey (const juce::ValueTree& child)
+    {
+        return &child.getProperties();
+    }
+
+    juce::Button* findButton (const juce::String& componentID) const
+    {
+        auto entry = buttonsById.find (componentID);
+        return entry != buttonsById.end() ? entry->second.getComponent() : nullptr;
+    }
+
+    juce::ValueTree findChild (const juce::String& componentID) const
+    {
+        auto entry = childrenById.find (componentID);
+        return entry != childrenById.end() ? entry->second : juce::ValueTree();
+    }
+
+    static bool isSelected (const juce::ValueTree& child)
+    {
+        return child.hasProperty (FF::propSelected) && static_cast<int> (child.getProperty (FF::propSelected)) != 0;
+    }
+
+    juce::SharedResourcePointer<ValueTreeAttachmentRouter> router;
     juce::ValueTree    tree;
     juce::Array<juce::Component::SafePointer<juce::Button> > buttons;
+    std::unordered_map<juce::String, juce::Component::SafePointer<juce::Button>, StringHash> buttonsById;
+    std::unordered_map<juce::String, juce::ValueTree, StringHash> childrenById;
+    std::unordered_map<const void*, juce::String>                  idsByChild;
+    juce::ValueTree    selectedChild;
+    juce::Button*      toggledButton = nullptr;
     juce::Identifier   property;
     bool               selectSubNodes;
     juce::UndoManager* undoMgr  = nullptr;
-    bool               updating = false;;
+    ValueTreeAttachmentTypedSync<juce::String> sync;
 
 };
@@ -44,17 +44,52 @@
 
 #pragma once
 
-#include <mutex>
+#include <algorithm>
+#include <iterator>
+#include <memory>
 #include <utility>
 
+/** Binds the value of a Slider as double, see ValueTreeAttachment */
+struct ValueTreeSliderTraits
+{
+    using ValueType = double;
+
+    static ValueType getValue (const juce::Slider& slider)
+    {
+        return slider.getValue();
+    }
+
+    static void setValue (juce::Slider& slider, ValueType value, juce::NotificationType notification)
+    {
+        slider.setValue (value, notification);
+    }
+
+    static constexpr juce::NotificationType initialNotification = juce::sendNotificationAsync;
+    static constexpr juce::NotificationType updateNotification  = juce::sendNotificationAsync;
+};
+
 /**
  \class ValueTreeSliderAttachment
  \brief This class updates a Slider to a property in a ValueTree
+
+ With setRangeProperties() also the range, interval and skew of the Slider are
+ bound to properties of the same node, by default FF::propMinimumDefault,
+ FF::propMaximumDefault, FF::propIntervalDefault and FF::propSkewDefault.
  */
-class ValueTreeSliderAttachment : public juce::Slider::Listener,
-                                  public juce::ValueTree::Listener
+class ValueTreeSliderAttachment : public ValueTreeAttachment<juce::Slider, ValueTreeSliderTraits>,
+                                  public juce::Slider::Listener
 {
 public:
+    /**
+     Defines, when the value is written to the tree while the user drags the Slider
+     */
+    enum class GestureWriteMode
+    {
+        continuous,     ///< write on every change, the default
+        rateLimited,    ///< write at most once per minimum interval, and on drag end
+        onDragEnd       ///< write only once the drag has ended
+    };
+
     /**
      Creates a ValueTreeSliderAttachment. The Slider gets it's values from properties of the ValueTree node.
      You can specify the names of the corresponding properties here.
@@ -63,31 +98,17 @@ public:
                                juce::Identifier valueProperty,
                                juce::Slider& _slider,
                                juce::UndoManager* undoManagerToUse = nullptr)
-    :   tree     (attachToTree),
-        slider   (_slider),
-        property (std::move(valueProperty)),
-        undoMgr  (undoManagerToUse)
+    :   ValueTreeAttachment (attachToTree, &_slider, std::move (valueProperty), undoManagerToUse)
     {
-        // Don't attach an invalid valuetree!
-        jassert (tree.isValid());
-
-        if (tree.hasProperty (property))
-        {
-            slider.setValue (tree.getProperty(property));
-        }
-        else
-        {
-            tree.setProperty (property, slider.getValue(), undoMgr);
-        }
-
-        tree.addListener (this);
-        slider.addListener (this);
+        _slider.addListener (this);
     }
 
-    ~ValueTreeSliderAttachment ()
+    ~ValueTreeSliderAttachment () override
     {
-        tree.removeListener (this);
-        slider.removeListener (this);
+        removeRangeTargets();
+        if (component) {
+            component->removeListener (this);
+        }
     }
 
     /**
@@ -95,42 +116,185 @@ public:
      */
     void sliderValueChanged (juce::Slider *sliderThatChanged) override
     {
-        if (std::unique_lock lock{mutex_, std::try_to_lock}; lock)
+        if (component == sliderThatChanged)
         {
-            if (&slider == sliderThatChanged)
+            if (! dragging || gestureWriteMode == GestureWriteMode::continuous)
+            {
+                writeSliderValue();
+            }
+            else if (gestureWriteMode == GestureWriteMode::rateLimited)
             {
-                tree.setProperty (property, slider.getValue(), undoMgr);
+                const auto now = juce::Time::getMillisecondCounter();
+                if (now - lastGestureWrite >= minimumWriteInterval)
+                {
+                    lastGestureWrite = now;
+                    writeSliderValue();
+                }
             }
         }
     }
 
     /**
-     This updates the Slider to reflect the ValueTree's property
+     A drag starts a new undo transaction, so all writes of the gesture are
+     coalesced into one undoable action.
      */
-    void valueTreePropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &changedProperty) override
+    void sliderDragStarted (juce::Slider *sliderThatChanged) override
     {
-        if (std::unique_lock lock{mutex_, std::try_to_lock}; lock)
+        if (component == sliderThatChanged)
         {
-            if (treeWhosePropertyHasChanged == tree)
+            dragging = true;
+            lastGestureWrite = juce::Time::getMillisecondCounter();
+            if (undoMgr != nullptr)
             {
-                if (changedProperty == property)
-                {
-                    slider.setValue (tree.getProperty (property));
-                }
+                undoMgr->beginNewTransaction();
+            }
+        }
+    }
+
+    /**
+     Writes the final value of the gesture and closes its undo transaction
+     */
+    void sliderDragEnded (juce::Slider *sliderThatChanged) override
+    {
+        if (component == sliderThatChanged)
+        {
+            dragging = false;
+            writeSliderValue();
+            if (undoMgr != nullptr)
+            {
+                undoMgr->beginNewTransaction();
             }
         }
     }
-    void valueTreeChildAdded (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenAdded) override {}
-    void valueTreeChildRemoved (juce::ValueTree &parentTree, juce::ValueTree &childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved) override {}
-    void valueTreeChildOrderChanged (juce::ValueTree &parentTreeWhoseChildrenHaveMoved, int oldIndex, int newIndex) override {}
-    void valueTreeParentChanged (juce::ValueTree &treeWhoseParentHasChanged) override {}
-    void valueTreeRedirected (juce::ValueTree &treeWhichHasBeenChanged) override {}
 
+    /**
+     Limits the writes to the tree while dragging. In rateLimited mode the value is
+     written at most every \param minimumIntervalMs milliseconds. In any mode the
+     final value is written when the drag ends.
+     */
+    void setGestureWriteMode (GestureWriteMode mode, int minimumIntervalMs = 50)
+    {
+        jassert (minimumIntervalMs >= 0);
+        gestureWriteMode     = mode;
+        minimumWriteInterval = static_cast<juce::uint32> (minimumIntervalMs);
+    }
+
+    /**
+     Binds the range of the Slider to properties of the same node and follows their
+     changes. Properties missing in the tree are initialised from the Slider. Once
+     bound, the values written to the tree are clamped and snapped to the range.
+     */
+    void setRangeProperties (juce::Identifier minimumProperty  = FF::propMinimumDefault,
+                             juce::Identifier maximumProperty  = FF::propMaximumDefault,
+                             juce::Identifier intervalProperty = FF::propIntervalDefault,
+                             juce::Identifier skewProperty     = FF::propSkewDefault)
+    {
+        if (! component) {
+            return;
+        }
+        removeRangeTargets();
+        // allocated only for sliders with bound range properties
+        boundRange = std::make_unique<BoundRange> (component->getNormalisableRange(), minimumProperty,
+                                                   maximumProperty, intervalProperty, skewProperty);
+
+        const juce::NormalisableRange<double>& current = boundRange->range;
+        const double defaults[] = { current.start, current.end, current.interval, current.skew };
+        for (int i=0; i < numRangeProperties; ++i) {
+            if (! tree.hasProperty (boundRange->properties [i])) {
+                tree.setProperty (boundRange->properties [i], defaults [i], undoMgr);
+            }
+            getRouter().addPropertyTarget (tree, boundRange->properties [i], this);
+        }
+        updateRange();
+    }
+
+    /** Updates the range of the Slider, if one of the range properties changed */
+    void routedPropertyChanged (juce::ValueTree &treeWhosePropertyHasChanged, const juce::Identifier &changedProperty) override
+    {
+        if (boundRange != nullptr && changedProperty != property && boundRange->isRangeProperty (changedProperty)) {
+            updateRange();
+        }
+        else {
+            ValueTreeAttachment::routedPropertyChanged (treeWhosePropertyHasChanged, changedProperty);
+        }
+    }
 
 private:
-    juce::ValueTree&   tree;
-    juce::Slider&      slider;
-    juce::Identifier   property;
-    juce::UndoManager* undoMgr;
-    std::mutex         mutex_;
+    static constexpr int numRangeProperties = 4;
+
+    /** The range bound to the tree and the properties it is read from */
+    struct BoundRange
+    {
+        BoundRange (const juce::NormalisableRange<double>& initialRange,
+                    const juce::Identifier& minimumProperty, const juce::Identifier& maximumProperty,
+                    const juce::Identifier& intervalProperty, const juce::Identifier& skewProperty)
+          : properties { minimumProperty, maximumProperty, intervalProperty, skewProperty },
+            range (initialRange)
+        {
+        }
+
+        bool isRangeProperty (const juce::Identifier& name) const
+        {
+            return std::find (std::begin (properties), std::end (properties), name) != std::end (properties);
+        }
+
+        juce::Identifier                properties [numRangeProperties];
+        juce::NormalisableRange<double> range;
+        bool                            isUpdating = false;
+    };
+
+    /** Reads the range properties once per change, the value updates use the cached range */
+    void updateRange ()
+    {
+        if (! component) {
+            return;
+        }
+        juce::NormalisableRange<double>& current = boundRange->range;
+        const double start    = tree.getProperty (boundRange->properties [0], current.start);
+        const double end      = tree.getProperty (boundRange->properties [1], current.end);
+        const double interval = tree.getProperty (boundRange->properties [2], 0.0);
+        const double skew     = tree.getProperty (boundRange->properties [3], 1.0);
+        if (end <= start || interval < 0.0 || skew <= 0.0) {
+            // wait for the other bounds, a range is often changed one property after the other
+            return;
+        }
+        if (start == current.start && end == current.end && interval == current.interval && skew == current.skew) {
+            return;
+        }
+        current = juce::NormalisableRange<double> (start, end, interval, skew);
+
+        boundRange->isUpdating = true;
+        component->setNormalisableRange (current);
+        boundRange->isUpdating = false;
+        // a value outside of the old range may fit now
+        resyncComponent();
+    }
+
+    /** Writes the value of the Slider constrained to the bound range */
+    void writeSliderValue ()
+    {
+        if (! component || (boundRange != nullptr && boundRange->isUpdating)) {
+            return;
+        }
+        const double value = component->getValue();
+        writeToTree (boundRange != nullptr ? boundRange->range.snapToLegalValue (value) : value);
+    }
+
+    void removeRangeTargets ()
+    {
+        if (boundRange == nullptr) {
+            return;
+        }
+        for (auto& rangeProperty : boundRange->properties) {
+            getRouter().removePropertyTarget (tree, rangeProperty, this);
+        }
+        boundRange.reset();
+    }
+
+    std::unique_ptr<BoundRange> boundRange;
+
+    GestureWriteMode   gestureWriteMode     = GestureWriteMode::continuous;
+    juce::uint32       minimumWriteInterval = 50;
+    juce::uint32       lastGestureWrite     = 0;
+    bool               dragging             = false;
 };
@@ -0,0 +1,406 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeTraceBuffer.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ \class ValueTreeTraceBuffer
+ \brief A preallocated lock free ring of binary ValueTree trace records
+
+ Writing a record costs a few nanoseconds: it stores a timestamp, the node, the
+ names of its type and the property, the event kind and the thread into a fixed
+ size slot, without building any string. A node is identified by the address of
+ its properties, like the ValueTreeAttachmentRouter does, so siblings of the same
+ type can be told apart. The names are kept alive in a table of the buffer and
+ stored as keys into it. When the ring is full the oldest records are
+ overwritten. The records are formatted only when the trace is read, see
+ getRecords() and writeText().
+
+ Any number of threads can write, the reader gets a consistent copy of each
+ record, that was not overwritten in the meantime.
+
+ Besides the ValueTree callbacks, the begin and end of each attachment callback
+ can be recorded. writeChromeTrace() exports all records as Chrome Trace Event
+ JSON, which can be opened in Perfetto or chrome://tracing.
+ */
+class ValueTreeTraceBuffer
+{
+public:
+    /** The kind of a ValueTree callback */
+    enum EventKind
+    {
+        propertyChanged = 0,
+        propertyRemoved,
+        childAdded,
+        childRemoved,
+        childOrderChanged,
+        parentChanged,
+        redirected,
+        callbackStarted,
+        callbackFinished
+    };
+
+    /** One binary trace record */
+    struct Record
+    {
+        juce::int64            timestamp;  ///< in high resolution ticks
+        const void*            node;       ///< the node, identified by the address of its properties
+        const void*            nodeType;   ///< the name of the node's type, see getName()
+        const void*            property;   ///< the name of the property or the child's type, see getName()
+        juce::Thread::ThreadID threadId;
+        const void*            target;     ///< the called attachment for callbackStarted and callbackFinished
+        const char*            targetName; ///< the type of the called attachment
+        double                 value;      ///< the new value, if it was numeric
+        juce::int32            kind;       ///< an EventKind
+        juce::int32            index;      ///< the child index or the old index
+        juce::int32            newIndex;
+        bool                   hasValue;
+    };
+
+    /** Creates a ring for at least \param capacity records, rounded up to a power of two */
+    explicit ValueTreeTraceBuffer (int capacity = 65536)
+    {
+        jassert (capacity > 0);
+        size_t size = 1;
+        while (size < static_cast<size_t> (capacity)) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        slots.reset (new Slot [size]);
+        names.reset (new NameEntry [numNames]);
+    }
+
+    /** Adds a record, overwriting the oldest one if the ring is full. Never blocks or allocates. */
+    void write (EventKind kind, const juce::ValueTree& node, const juce::Identifier& property,
+                const juce::var* value = nullptr, int index = -1, int newIndex = -1) noexcept
+    {
+        writeRecord ([&] (Record& record) {
+            record.node     = getNodeKey (node);
+            record.nodeType = addName (node.getType());
+            record.property = addName (property);
+            record.kind     = kind;
+            record.index    = index;
+            record.newIndex = newIndex;
+            record.hasValue = value != nullptr && (value->isDouble() || value->isInt() || value->isInt64() || value->isBool());
+            record.value    = record.hasValue ? static_cast<double> (*value) : 0.0;
+        });
+    }
+
+    /**
+     Adds the begin or end of an attachment callback. The \param targetName has to
+     be a static string, e.g. from typeid.
+     */
+    void writeCallback (EventKind kind, const void* target, const char* targetName,
+                        const juce::ValueTree* node, const juce::Identifier& property) noexcept
+    {
+        writeRecord ([&] (Record& record) {
+            record.node       = node != nullptr ? getNodeKey (*node) : nullptr;
+            record.nodeType   = node != nullptr ? addName (node->getType()) : nullptr;
+            record.property   = addName (property);
+            record.target     = target;
+            record.targetName = targetName;
+            record.kind       = kind;
+        });
+    }
+
+    /**
+     Copies the records still in the ring, oldest first. Records being written or
+     overwritten while reading are skipped.
+     */
+    std::vector<Record> getRecords () const
+    {
+        const juce::uint64 end   = writePosition.load (std::memory_order_acquire);
+        const juce::uint64 size  = mask + 1;
+        const juce::uint64 start = juce::jmax (end > size ? end - size : juce::uint64 (0), clearedPosition.load());
+
+        std::vector<Record> records;
+        records.reserve (static_cast<size_t> (end - start));
+        for (juce::uint64 position = start; position < end; ++position) {
+            const Slot& slot = slots [static_cast<size_t> (position & mask)];
+            const juce::uint64 expected = 2 * position + 2;
+            if (slot.sequence.load (std::memory_order_acquire) != expected) {
+                continue;
+            }
+            const Record copy = slot.record;
+            std::atomic_thread_fence (std::memory_order_acquire);
+            if (slot.sequence.load (std::memory_order_relaxed) == expected) {
+                records.push_back (copy);
+            }
+        }
+        return records;
+    }
+
+    /** Forgets all records written so far */
+    void clear () noexcept
+    {
+        clearedPosition.store (writePosition.load());
+    }
+
+    /** Returns the number of records written since the last clear, including overwritten ones */
+    juce::uint64 getNumWritten () const noexcept
+    {
+        return writePosition.load() - clearedPosition.load();
+    }
+
+    int getCapacity () const noexcept
+    {
+        return static_cast<int> (mask + 1);
+    }
+
+    /** Returns the name behind the nodeType or property key of a record */
+    juce::String getName (const void* nameKey) const
+    {
+        if (nameKey == nullptr) {
+            return {};
+        }
+        for (size_t probe = 0, index = getNameIndex (nameKey); probe < numNames; ++probe, index = (index + 1) & (numNames - 1)) {
+            const NameEntry& entry = names [index];
+            const void* key = entry.key.load (std::memory_order_acquire);
+            if (key == nameKey) {
+                return entry.ready.load (std::memory_order_acquire) ? entry.name.toString() : juce::String();
+            }
+            if (key == nullptr) {
+                break;
+            }
+        }
+        return {};
+    }
+
+    /** Returns a readable name for an EventKind */
+    static const char* getKindName (int kind)
+    {
+        switch (kind) {
+            case propertyChanged:   return "property changed";
+            case propertyRemoved:   return "property removed";
+            case childAdded:        return "child added";
+            case childRemoved:      return "child removed";
+            case childOrderChanged: return "child order changed";
+            case parentChanged:     return "parent changed";
+            case redirected:        return "redirected";
+            case callbackStarted:   return "callback started";
+            case callbackFinished:  return "callback finished";
+            default:                return "unknown";
+        }
+    }
+
+    /**
+     Exports the records as Chrome Trace Event JSON. Attachment callbacks become
+     duration events, nested on their thread, the ValueTree callbacks instant events.
+     */
+    void writeChromeTrace (juce::OutputStream& out) const
+    {
+        const auto records = getRecords();
+        const juce::int64 origin = records.empty() ? 0 : records.front().timestamp;
+        juce::Array<juce::Thread::ThreadID> threads;
+
+        out << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto& record : records) {
+            if (threads.indexOf (record.threadId) < 0) {
+                threads.add (record.threadId);
+            }
+            out << (first ? "\n" : ",\n");
+            first = false;
+
+            const double micros = juce::Time::highResolutionTicksToSeconds (record.timestamp - origin) * 1.0e6;
+            out << "{\"pid\":1,\"tid\":" << (threads.indexOf (record.threadId) + 1)
+                << ",\"ts\":" << juce::String (micros, 3);
+
+            if (record.kind == callbackStarted || record.kind == callbackFinished) {
+                out << ",\"ph\":\"" << (record.kind == callbackStarted ? "B" : "E") << "\"";
+                if (record.kind == callbackStarted) {
+                    out << ",\"cat\":\"attachment\",\"name\":\"" << escape (getTargetName (record.targetName)) << "\""
+                        << ",\"args\":{\"node\":\"" << escape (getName (record.nodeType))
+                        << "\",\"nodeId\":\"" << juce::String::toHexString ((juce::pointer_sized_int) record.node)
+                        << "\",\"property\":\"" << escape (getName (record.property))
+                        << "\",\"target\":\"" << juce::String::toHexString ((juce::pointer_sized_int) record.target) << "\"}";
+                }
+            }
+            else {
+                out << ",\"ph\":\"i\",\"s\":\"t\",\"cat\":\"valuetree\",\"name\":\"" << getKindName (record.kind) << "\""
+                    << ",\"args\":{\"node\":\"" << escape (getName (record.nodeType))
+                    << "\",\"nodeId\":\"" << juce::String::toHexString ((juce::pointer_sized_int) record.node)
+                    << "\",\"property\":\"" << escape (getName (record.property)) << "\"";
+                if (record.hasValue) {
+                    out << ",\"value\":" << juce::String (record.value);
+                }
+                out << "}";
+            }
+            out << "}";
+        }
+        out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+    }
+
+    /** Formats the records as text, one line per record */
+    void writeText (juce::OutputStream& out) const
+    {
+        const auto records = getRecords();
+        const juce::int64 origin = records.empty() ? 0 : records.front().timestamp;
+        for (const auto& record : records) {
+            const double micros = juce::Time::highResolutionTicksToSeconds (record.timestamp - origin) * 1.0e6;
+            out << juce::String (micros, 1) << "us [" << juce::String::toHexString ((juce::pointer_sized_int) record.threadId)
+                << "] <" << getName (record.nodeType) << " " << juce::String::toHexString ((juce::pointer_sized_int) record.node)
+                << "> " << getKindName (record.kind);
+            if (record.kind == callbackStarted) {
+                out << " " << getTargetName (record.targetName);
+            }
+            if (record.property != nullptr) {
+                out << " \"" << getName (record.property) << "\"";
+            }
+            if (record.hasValue) {
+                out << " = " << juce::String (record.value);
+            }
+            if (record.index >= 0) {
+                out << " index " << juce::String (record.index);
+            }
+            if (record.newIndex >= 0) {
+                out << " to " << juce::String (record.newIndex);
+            }
+            out << juce::newLine;
+        }
+    }
+
+private:
+    template<typename Fill>
+    void writeRecord (Fill&& fill) noexcept
+    {
+        const juce::uint64 position = writePosition.fetch_add (1, std::memory_order_relaxed);
+        Slot& slot = slots [static_cast<size_t> (position & mask)];
+
+        // an odd sequence marks the slot as being written
+        slot.sequence.store (2 * position + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence (std::memory_order_release);
+
+        slot.record = Record();
+        slot.record.timestamp = juce::Time::getHighResolutionTicks();
+        slot.record.threadId  = juce::Thread::getCurrentThreadId();
+        slot.record.index     = -1;
+        slot.record.newIndex  = -1;
+        fill (slot.record);
+
+        slot.sequence.store (2 * position + 2, std::memory_order_release);
+    }
+
+    /** The same key the router uses for a node */
+    static const void* getNodeKey (const juce::ValueTree& node) noexcept
+    {
+        return &node.getProperties();
+    }
+
+    /**
+     Keeps a copy of the Identifier in the name table, so the pooled string stays
+     alive until the trace is read, and returns its key. Lock free and never
+     allocates; if the table is full the name is left out.
+     */
+    const void* addName (const juce::Identifier& name) noexcept
+    {
+        if (! name.isValid()) {
+            return nullptr;
+        }
+        const void* nameKey = name.getCharPointer().getAddress();
+        for (size_t probe = 0, index = getNameIndex (nameKey); probe < numNames; ++probe, index = (index + 1) & (numNames - 1)) {
+            NameEntry& entry = names [index];
+            const void* key = entry.key.load (std::memory_order_acquire);
+            if (key == nullptr && entry.key.compare_exchange_strong (key, nameKey, std::memory_order_acq_rel)) {
+                entry.name = name;
+                entry.ready.store (true, std::memory_order_release);
+                return nameKey;
+            }
+            if (key == nameKey) {
+                return nameKey;
+            }
+        }
+        return nullptr;
+    }
+
+    static size_t getNameIndex (const void* nameKey) noexcept
+    {
+        return std::hash<const void*>() (nameKey) & (numNames - 1);
+    }
+
+    /** Strips the length prefix some compilers put in front of type names */
+    static juce::String getTargetName (const char* typeName)
+    {
+        if (typeName == nullptr) {
+            return "unknown";
+        }
+        while (*typeName >= '0' && *typeName <= '9') {
+            ++typeName;
+        }
+        return juce::String (typeName);
+    }
+
+    static juce::String escape (const juce::String& text)
+    {
+        return text.replace ("\\", "\\\\").replace ("\"", "\\\"");
+    }
+
+    struct Slot
+    {
+        std::atomic<juce::uint64> sequence { 0 };
+        Record                    record {};
+    };
+
+    struct NameEntry
+    {
+        std::atomic<const void*> key   { nullptr };
+        std::atomic<bool>        ready { false };
+        juce::Identifier         name;
+    };
+
+    static constexpr size_t numNames = 1024;
+
+    std::unique_ptr<Slot[]>      slots;
+    std::unique_ptr<NameEntry[]> names;
+    juce::uint64                 mask = 0;
+    std::atomic<juce::uint64>    writePosition   { 0 };
+    std::atomic<juce::uint64>    clearedPosition { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeTraceBuffer)
+};
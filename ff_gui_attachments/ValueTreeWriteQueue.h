@@ -0,0 +1,305 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeWriteQueue.h
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+/**
+ \class ValueTreeWriteQueue
+ \brief Lets the audio thread write values into the tree
+
+ Calling setProperty from the audio thread is not safe. Instead the audio thread
+ pushes (binding, value) records into this wait free single producer, single
+ consumer queue. On the message thread the queue is drained periodically, only
+ the latest value of each binding is written to the tree and the attachments
+ pick it up as usual. This is meant for meters, learned ranges or detected values.
+
+ The drain timer only runs while records are waiting. The first push after the
+ queue went idle posts one message to start it, all other pushes only write into
+ the fifo. Each drain batches only the trees it writes to, so the attachments of
+ other trees, e.g. of another plugin instance, are not held back.
+
+ Add the bindings on the message thread, before the audio thread starts pushing.
+
+ \code{.cpp}
+    // message thread
+    const int reduction = writeQueue.addBinding (meters, "gainReduction");
+
+    // audio thread
+    writeQueue.push (reduction, compressor.getGainReduction());
+ \endcode
+ */
+class ValueTreeWriteQueue : private juce::Timer,
+                            private juce::AsyncUpdater
+{
+public:
+    /**
+     Creates a queue with space for \param capacity records between two drains.
+     The queue is drained \param drainsPerSecond times per second.
+     */
+    explicit ValueTreeWriteQueue (int capacity = 1024, int drainsPerSecond = 30)
+    :   fifo (capacity),
+        records (static_cast<size_t> (capacity)),
+        drainRate (drainsPerSecond)
+    {
+        jassert (capacity > 1);
+        jassert (drainsPerSecond > 0);
+    }
+
+    ~ValueTreeWriteQueue () override
+    {
+        cancelPendingUpdate();
+        stopTimer();
+    }
+
+    /**
+     Adds a property the audio thread can write to and returns the id to push to.
+     The values are written without undo manager, unless one is given.
+     Call this only on the message thread.
+     */
+    int addBinding (const juce::ValueTree& tree, const juce::Identifier& property,
+                    juce::UndoManager* undoManager = nullptr)
+    {
+        jassert (tree.isValid());
+        bindings.emplace_back (tree, property, undoManager);
+        return static_cast<int> (bindings.size()) - 1;
+    }
+
+    int getNumBindings () const
+    {
+        return static_cast<int> (bindings.size());
+    }
+
+    /**
+     Pushes a value for the binding. This never blocks or allocates. If the queue
+     is full the value is dropped and false is returned.
+     */
+    bool push (int bindingId, float value) noexcept
+    {
+        return pushRecord ({ bindingId, false, value, 0 });
+    }
+
+    /**
+     Pushes a double value. It is transported as float, so a double argument
+     doesn't need a cast to pick one of the other overloads.
+     */
+    bool push (int bindingId, double value) noexcept
+    {
+        return push (bindingId, static_cast<float> (value));
+    }
+
+    /** Pushes an integer value, e.g. an index or a detected key */
+    bool push (int bindingId, int value) noexcept
+    {
+        return pushRecord ({ bindingId, true, 0.0f, value });
+    }
+
+    /** Returns the number of records dropped, because the queue was full */
+    int getNumDroppedRecords () const noexcept
+    {
+        return dropped.load (std::memory_order_relaxed);
+    }
+
+    /**
+     Writes the latest value of each binding to the tree. This is called by the
+     timer, but can also be called manually on the message thread.
+     */
+    void drain ()
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (fifo.getNumReady(), start1, size1, start2, size2);
+        if (size1 + size2 == 0) {
+            stopWhenIdle();
+            return;
+        }
+        collectRecords (start1, size1);
+        collectRecords (start2, size2);
+        fifo.finishedRead (size1 + size2);
+
+        // only the trees written to are batched
+        batchRoots.clearQuick();
+        for (auto& binding : bindings) {
+            if (binding.hasPendingValue) {
+                batchRoots.addIfNotAlreadyThere (binding.tree.getRoot());
+            }
+        }
+        for (auto& root : batchRoots) {
+            router->beginBatch (root);
+        }
+        for (auto& binding : bindings) {
+            if (binding.hasPendingValue) {
+                binding.hasPendingValue = false;
+                binding.tree.setProperty (binding.property, binding.pendingValue, binding.undoManager);
+            }
+        }
+        for (auto& root : batchRoots) {
+            router->endBatch (root);
+        }
+    }
+
+    /** Sets how often the queue is drained while records are waiting */
+    void setDrainRate (int drainsPerSecond)
+    {
+        jassert (drainsPerSecond > 0);
+        drainRate = drainsPerSecond;
+        if (isTimerRunning()) {
+            startTimerHz (drainRate);
+        }
+    }
+
+    /** Returns true while the drain timer runs */
+    bool isDraining () const
+    {
+        return isTimerRunning();
+    }
+
+private:
+    struct Record
+    {
+        int   binding;
+        bool  isInteger;
+        float floatValue;
+        int   intValue;
+    };
+
+    struct Binding
+    {
+        Binding (const juce::ValueTree& treeToWrite, const juce::Identifier& propertyToWrite,
+                 juce::UndoManager* undoManagerToUse)
+          : tree (treeToWrite),
+            property (propertyToWrite),
+            undoManager (undoManagerToUse)
+        {
+        }
+
+        juce::ValueTree    tree;
+        juce::Identifier   property;
+        juce::UndoManager* undoManager     = nullptr;
+        juce::var          pendingValue;
+        bool               hasPendingValue = false;
+    };
+
+    bool pushRecord (const Record& record) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+        if (size1 + size2 == 0) {
+            dropped.fetch_add (1, std::memory_order_relaxed);
+            return false;
+        }
+        records [static_cast<size_t> (size1 > 0 ? start1 : start2)] = record;
+        fifo.finishedWrite (1);
+        wakeUp();
+        return true;
+    }
+
+    /** Only the first push after the queue went idle posts a message to start the timer */
+    void wakeUp () noexcept
+    {
+        if (! awake.load() && ! awake.exchange (true)) {
+            triggerAsyncUpdate();
+        }
+    }
+
+    void handleAsyncUpdate () override
+    {
+        startTimerHz (drainRate);
+    }
+
+    /**
+     Stops the timer after a drain found nothing to do. A push arriving meanwhile
+     either finds the queue asleep and wakes it up, or is seen by the check here.
+     */
+    void stopWhenIdle ()
+    {
+        awake.store (false);
+        if (fifo.getNumReady() > 0) {
+            awake.store (true);
+        }
+        else {
+            stopTimer();
+        }
+    }
+
+    /** Keeps only the latest value of each binding */
+    void collectRecords (int start, int size)
+    {
+        for (int i=start; i < start + size; ++i) {
+            const Record& record = records [static_cast<size_t> (i)];
+            if (juce::isPositiveAndBelow (record.binding, static_cast<int> (bindings.size()))) {
+                Binding& binding = bindings [static_cast<size_t> (record.binding)];
+                if (record.isInteger) {
+                    binding.pendingValue = record.intValue;
+                }
+                else {
+                    binding.pendingValue = record.floatValue;
+                }
+                binding.hasPendingValue = true;
+            }
+            else {
+                // push only ids returned by addBinding
+                jassertfalse;
+            }
+        }
+    }
+
+    void timerCallback () override
+    {
+        drain();
+    }
+
+    juce::AbstractFifo   fifo;
+    std::vector<Record>  records;
+    std::vector<Binding> bindings;
+    std::atomic<int>     dropped { 0 };
+    std::atomic<bool>    awake   { false };
+    int                  drainRate;
+
+    juce::SharedResourcePointer<ValueTreeAttachmentRouter> router;
+    juce::Array<juce::ValueTree>                           batchRoots;
+
+    JUCE_DECLARE_NON_COPYABLE (ValueTreeWriteQueue)
+};
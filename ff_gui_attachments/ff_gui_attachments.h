@@ -62,6 +62,15 @@
  that are not exposed to the host as parameters.
  
  \see ValueTreeSliderAttachment, ValueTreeComboBoxAttachment, ValueTreeRadioButtonGroupAttachment, ValueTreeLabelAttachment
+
+ The attachments don't listen to the ValueTree themselves, they share one
+ ValueTreeAttachmentRouter, that registers a single listener per node and
+ forwards each change only to the attachments bound to that node and property.
+ Slider, Button, Label and the index mode of the ComboBox share the
+ ValueTreeAttachment template, which gets the type and access of the value from
+ a traits class at compile time.
+ To change many properties at once, e.g. when loading a preset, keep a
+ ScopedAttachmentBatch alive meanwhile, so each attachment is updated only once.
  
  They are used exatly the same as AudioProcessorValueTree::SliderAttachment.
  In the ValueTreeSliderAttachment you can also supply a range for the slider.
@@ -97,16 +106,40 @@
 #include <juce_data_structures/juce_data_structures.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
+/** Config: FF_ATTACHMENT_STATS
+    Enables per attachment counters and callback histograms in ValueTreeAttachmentStats.
+    When disabled, the instrumentation compiles to nothing.
+*/
+#ifndef FF_ATTACHMENT_STATS
+ #define FF_ATTACHMENT_STATS 0
+#endif
+
 namespace FF {
     static juce::Identifier propSelected        ("selected");
     static juce::Identifier propMinimumDefault  ("minimum");
     static juce::Identifier propMaximumDefault  ("maximum");
     static juce::Identifier propIntervalDefault ("interval");
+    static juce::Identifier propSkewDefault     ("skew");
 };
 
+#include "ValueTreeAttachmentRouter.h"
+#include "ValueTreeAttachmentSync.h"
+#include "ValueTreeAttachmentStats.h"
+#include "ValueTreeAttachmentFrameDriver.h"
+#include "ValueTreeParameterBlock.h"
+#include "ValueTreeAttachmentVisibilityWatcher.h"
+#include "ValueTreeAttachmentContext.h"
+#include "ValueTreeAttachment.h"
+#include "ScopedAttachmentBatch.h"
+#include "ValueTreeDiff.h"
+#include "ValueTreeWriteQueue.h"
 #include "ValueTreeSliderAttachment.h"
 #include "ValueTreeComboBoxAttachment.h"
 #include "ValueTreeRadioButtonGroupAttachment.h"
 #include "ValueTreeLabelAttachment.h"
+#include "ValueTreeTraceBuffer.h"
 #include "ValueTreeDebugListener.h"
+#include "ValueTreeCascadeAnalyzer.h"
 #include "ValueTreeButtonAttachment.h"
+#include "ValueTreeAttachmentSet.h"
+#include "ValueTreeAttachmentBinder.h"
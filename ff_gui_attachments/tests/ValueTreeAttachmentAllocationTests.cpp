@@ -0,0 +1,139 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentAllocationTests.cpp
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+#if JUCE_ENABLE_ALLOCATION_HOOKS
+
+/**
+ Checks, that routing a changed value to its attachment doesn't allocate, once
+ the attachments are set up. This needs the allocation hooks of juce_core.
+ */
+class ValueTreeAttachmentAllocationTests : public juce::UnitTest
+{
+public:
+    ValueTreeAttachmentAllocationTests () : juce::UnitTest ("ValueTreeAttachmentAllocation", "ff_gui_attachments") {}
+
+    void runTest () override
+    {
+        beginTest ("Tree to component updates don't allocate");
+        {
+            juce::ValueTree tree ("Controls");
+            juce::Slider slider;
+            juce::ToggleButton button;
+            juce::ComboBox comboBox;
+            juce::Label label;
+            comboBox.addItem ("a", 1);
+            comboBox.addItem ("b", 2);
+            comboBox.addItem ("c", 3);
+
+            ValueTreeSliderAttachment   sliderAttachment (tree, "slider", slider);
+            ValueTreeButtonAttachment   buttonAttachment (tree, &button, "button");
+            ValueTreeComboBoxAttachment comboBoxAttachment (tree, &comboBox, "combo", false);
+            ValueTreeLabelAttachment    labelAttachment (tree, &label, "label");
+
+            Radio radio;
+            ValueTreeRadioButtonGroupAttachment radioAttachment (tree, radio.pointers, "radio", false);
+
+            const juce::var texts[] = { "one", "two" };
+            const juce::var ids[]   = { "r0", "r1" };
+            auto change = [&] (int i) {
+                tree.setProperty ("slider", static_cast<double> (i % 10), nullptr);
+                tree.setProperty ("button", i % 2 == 0, nullptr);
+                tree.setProperty ("combo", i % 3, nullptr);
+                tree.setProperty ("label", texts [i % 2], nullptr);
+                tree.setProperty ("radio", ids [i % 2], nullptr);
+            };
+
+            // the first changes may grow the buffers of the components and the router
+            for (int i=0; i < 10; ++i) {
+                change (i);
+            }
+
+            AllocationCounter counter;
+            for (int i=0; i < 100; ++i) {
+                change (i);
+            }
+            expectEquals (counter.count, 0);
+        }
+    }
+
+private:
+    struct AllocationCounter : public juce::AllocationHooks::Listener
+    {
+        AllocationCounter ()
+        {
+            juce::getAllocationHooksForThread().addListener (this);
+        }
+
+        ~AllocationCounter () override
+        {
+            juce::getAllocationHooksForThread().removeListener (this);
+        }
+
+        void newOrDeleteCalled () noexcept override
+        {
+            ++count;
+        }
+
+        int count = 0;
+    };
+
+    struct Radio
+    {
+        Radio ()
+        {
+            for (int i=0; i < 2; ++i) {
+                buttons [i].setComponentID ("r" + juce::String (i));
+                buttons [i].setRadioGroupId (1);
+                pointers.add (&buttons [i]);
+            }
+        }
+
+        juce::ToggleButton         buttons [2];
+        juce::Array<juce::Button*> pointers;
+    };
+};
+
+static ValueTreeAttachmentAllocationTests valueTreeAttachmentAllocationTests;
+
+#endif
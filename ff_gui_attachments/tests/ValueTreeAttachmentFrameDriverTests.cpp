@@ -0,0 +1,138 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentFrameDriverTests.cpp
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+/**
+ Checks, that the updates at the end of a batch are spread over several frames
+ when a frame budget is set, and shown at once without one
+ */
+class ValueTreeAttachmentFrameDriverTests : public juce::UnitTest
+{
+public:
+    ValueTreeAttachmentFrameDriverTests () : juce::UnitTest ("ValueTreeAttachmentFrameDriver", "ff_gui_attachments") {}
+
+    void runTest () override
+    {
+        beginTest ("A batch larger than the budget spans several frames");
+        {
+            Bindings bindings;
+            driver->setFrameBudget (1.0);
+            bindings.setAll (1.0);
+            expectEquals (driver->getNumPendingClients(), numBindings, "the batch end leaves the updates to the driver");
+            expectEquals (bindings.countShowing (1.0), 0);
+
+            int frames = 0;
+            while (driver->getNumPendingClients() > 0 && frames < numBindings) {
+                driver->flushFrame();
+                ++frames;
+                // each update takes longer than a fifth of the budget
+                expectLessOrEqual (numBindings - driver->getNumPendingClients(), frames * 5);
+            }
+            expectGreaterThan (frames, 1);
+            expectEquals (driver->getNumPendingClients(), 0);
+            expectEquals (bindings.countShowing (1.0), numBindings);
+            driver->setFrameBudget (0.0);
+        }
+
+        beginTest ("Without a budget the batch end updates at once");
+        {
+            Bindings bindings;
+            bindings.setAll (1.0);
+            expectEquals (driver->getNumPendingClients(), 0);
+            expectEquals (bindings.countShowing (1.0), numBindings);
+        }
+    }
+
+private:
+    static constexpr int numBindings = 20;
+
+    /** A Slider binding, whose component update takes a fixed time */
+    struct SlowSliderTraits : public ValueTreeSliderTraits
+    {
+        static void setValue (juce::Slider& slider, ValueType value, juce::NotificationType notification)
+        {
+            const auto end = juce::Time::getHighResolutionTicks() + juce::Time::secondsToHighResolutionTicks (0.0003);
+            while (juce::Time::getHighResolutionTicks() < end) {}
+            slider.setValue (value, notification);
+        }
+
+        static constexpr juce::NotificationType updateNotification = juce::dontSendNotification;
+    };
+
+    using SlowAttachment = ValueTreeAttachment<juce::Slider, SlowSliderTraits>;
+
+    struct Bindings
+    {
+        Bindings ()
+        {
+            for (int i=0; i < numBindings; ++i) {
+                attachments.add (new SlowAttachment (tree, &sliders [i], "value" + juce::String (i)));
+            }
+        }
+
+        /** Changes all values in one batch */
+        void setAll (double value)
+        {
+            const ScopedAttachmentBatch batch (tree);
+            for (int i=0; i < numBindings; ++i) {
+                tree.setProperty ("value" + juce::String (i), value, nullptr);
+            }
+        }
+
+        int countShowing (double value) const
+        {
+            int count = 0;
+            for (auto& slider : sliders) {
+                count += slider.getValue() == value ? 1 : 0;
+            }
+            return count;
+        }
+
+        juce::ValueTree                 tree { "Test" };
+        juce::Slider                    sliders [numBindings];
+        juce::OwnedArray<SlowAttachment> attachments;
+    };
+
+    juce::SharedResourcePointer<ValueTreeAttachmentFrameDriver> driver;
+};
+
+static ValueTreeAttachmentFrameDriverTests valueTreeAttachmentFrameDriverTests;
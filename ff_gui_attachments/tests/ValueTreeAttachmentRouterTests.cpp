@@ -0,0 +1,144 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentRouterTests.cpp
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+/**
+ Checks, that targets removed while a change is dispatched neither skip nor
+ repeat the remaining targets
+ */
+class ValueTreeAttachmentRouterTests : public juce::UnitTest
+{
+public:
+    ValueTreeAttachmentRouterTests () : juce::UnitTest ("ValueTreeAttachmentRouter", "ff_gui_attachments") {}
+
+    void runTest () override
+    {
+        beginTest ("A target removes itself and a sibling");
+        {
+            juce::ValueTree tree ("Test");
+            Target targets [numTargets];
+            for (auto& target : targets) {
+                router->addPropertyTarget (tree, "value", &target);
+            }
+            // one sibling called before and one called after the removing target
+            targets [2].toRemove.add (&targets [2]);
+            targets [2].toRemove.add (&targets [1]);
+            targets [2].toRemove.add (&targets [3]);
+            for (auto& target : targets) {
+                target.tree = tree;
+            }
+
+            tree.setProperty ("value", 1, nullptr);
+            expectEquals (targets [0].calls, 1);
+            expectEquals (targets [2].calls, 1);
+            expectEquals (targets [4].calls, 1);
+            expectLessOrEqual (targets [1].calls + targets [3].calls, 1, "a removed target is called at most once");
+
+            tree.setProperty ("value", 2, nullptr);
+            expectEquals (targets [0].calls, 2);
+            expectEquals (targets [2].calls, 1);
+            expectEquals (targets [4].calls, 2);
+            expectLessOrEqual (targets [1].calls + targets [3].calls, 1, "removed targets are not called again");
+
+            for (auto& target : targets) {
+                router->removePropertyTarget (tree, "value", &target);
+            }
+            expectEquals (router->getNumListenedNodes(), 0);
+        }
+
+        beginTest ("A target removes itself during a nested dispatch");
+        {
+            juce::ValueTree tree ("Test");
+            Target targets [numTargets];
+            for (auto& target : targets) {
+                target.tree = tree;
+                router->addPropertyTarget (tree, "value", &target);
+            }
+            // the first call writes again, so the removal happens inside the inner dispatch
+            targets [4].writeOnce = true;
+            targets [1].toRemove.add (&targets [1]);
+            targets [1].toRemove.add (&targets [0]);
+
+            tree.setProperty ("value", 1, nullptr);
+            expectEquals (targets [2].calls, 2, "called once per change");
+            expectEquals (targets [3].calls, 2, "called once per change");
+            expectEquals (targets [4].calls, 2, "called once per change");
+            expectEquals (targets [1].calls, 1);
+            expectLessOrEqual (targets [0].calls, 1);
+
+            for (auto& target : targets) {
+                router->removePropertyTarget (tree, "value", &target);
+            }
+            expectEquals (router->getNumListenedNodes(), 0);
+        }
+    }
+
+private:
+    static constexpr int numTargets = 5;
+
+    /** Counts its calls and removes the listed targets when called */
+    struct Target : public ValueTreeAttachmentRouter::Target
+    {
+        void routedPropertyChanged (juce::ValueTree&, const juce::Identifier& property) override
+        {
+            ++calls;
+            if (writeOnce) {
+                writeOnce = false;
+                tree.setProperty (property, static_cast<int> (tree.getProperty (property)) + 1, nullptr);
+            }
+            for (auto* target : toRemove) {
+                router->removePropertyTarget (tree, property, target);
+            }
+            toRemove.clear();
+        }
+
+        juce::SharedResourcePointer<ValueTreeAttachmentRouter> router;
+        juce::ValueTree        tree;
+        juce::Array<Target*>   toRemove;
+        int                    calls     = 0;
+        bool                   writeOnce = false;
+    };
+
+    juce::SharedResourcePointer<ValueTreeAttachmentRouter> router;
+};
+
+static ValueTreeAttachmentRouterTests valueTreeAttachmentRouterTests;
@@ -0,0 +1,155 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentStatsTests.cpp
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+#if FF_ATTACHMENT_STATS
+
+/**
+ Checks the counters of ValueTreeAttachmentStats, and that each component is
+ registered as one binding
+ */
+class ValueTreeAttachmentStatsTests : public juce::UnitTest
+{
+public:
+    ValueTreeAttachmentStatsTests () : juce::UnitTest ("ValueTreeAttachmentStats", "ff_gui_attachments") {}
+
+    void runTest () override
+    {
+        beginTest ("Each ComboBox is one binding");
+        {
+            juce::ValueTree tree ("Test");
+            tree.appendChild (juce::ValueTree ("option"), nullptr);
+            juce::ComboBox indexCombo, nodeCombo;
+            const int before = getNumBindings();
+            {
+                ValueTreeComboBoxAttachment attachment (tree, &indexCombo, "index", false);
+                expectEquals (getNumBindings(), before + 1, "the index mode registers once");
+            }
+            {
+                ValueTreeComboBoxAttachment attachment (tree, &nodeCombo, "name", true);
+                expectEquals (getNumBindings(), before + 1);
+            }
+            expectEquals (getNumBindings(), before);
+        }
+
+        beginTest ("Updates, writes and echoes are counted");
+        {
+            juce::ValueTree tree ("Test");
+            juce::Label label;
+            label.setComponentID ("statsLabel");
+            ValueTreeLabelAttachment attachment (tree, &label, "text");
+            stats->reset();
+
+            tree.setProperty ("text", "tree", nullptr);
+            label.setText ("label", juce::sendNotificationSync);
+            label.setText ("label", juce::sendNotificationSync);
+
+            const auto snapshot = findBinding ("text (statsLabel)");
+            expectEquals (static_cast<int> (snapshot.counters [ValueTreeAttachmentStats::treeToComponentUpdates]), 1);
+            expectEquals (static_cast<int> (snapshot.counters [ValueTreeAttachmentStats::componentToTreeWrites]), 1);
+            expectEquals (static_cast<int> (snapshot.counters [ValueTreeAttachmentStats::suppressedEchoes]), 1);
+            expectEquals (static_cast<int> (snapshot.counters [ValueTreeAttachmentStats::unchangedWrites]), 0);
+        }
+
+        beginTest ("The slowest binding comes first");
+        {
+            juce::ValueTree tree ("Test");
+            juce::Slider fast, slow;
+            fast.setComponentID ("fast");
+            slow.setComponentID ("slow");
+            ValueTreeAttachment<juce::Slider, SlowSliderTraits> slowAttachment (tree, &slow, "slow");
+            ValueTreeAttachment<juce::Slider, FastSliderTraits> fastAttachment (tree, &fast, "fast");
+            stats->reset();
+
+            for (int i=1; i <= 3; ++i) {
+                tree.setProperty ("fast", i, nullptr);
+                tree.setProperty ("slow", i, nullptr);
+            }
+
+            const auto top = stats->getTopBindings (2);
+            expectEquals (static_cast<int> (top.size()), 2);
+            expectEquals (top [0].name, juce::String ("slow (slow)"));
+            expectEquals (top [1].name, juce::String ("fast (fast)"));
+            expectGreaterThan (top [0].getTotalSeconds(), top [1].getTotalSeconds());
+            expectEquals (static_cast<int> (top [0].counters [ValueTreeAttachmentStats::treeToComponentUpdates]), 3);
+        }
+    }
+
+private:
+    struct FastSliderTraits : public ValueTreeSliderTraits
+    {
+        static constexpr juce::NotificationType initialNotification = juce::dontSendNotification;
+        static constexpr juce::NotificationType updateNotification  = juce::dontSendNotification;
+    };
+
+    /** Takes a millisecond for each update */
+    struct SlowSliderTraits : public FastSliderTraits
+    {
+        static void setValue (juce::Slider& slider, ValueType value, juce::NotificationType notification)
+        {
+            const auto end = juce::Time::getHighResolutionTicks() + juce::Time::secondsToHighResolutionTicks (0.001);
+            while (juce::Time::getHighResolutionTicks() < end) {}
+            slider.setValue (value, notification);
+        }
+    };
+
+    int getNumBindings () const
+    {
+        return static_cast<int> (stats->getTopBindings (std::numeric_limits<int>::max()).size());
+    }
+
+    ValueTreeAttachmentStats::Snapshot findBinding (const juce::String& name) const
+    {
+        for (const auto& snapshot : stats->getTopBindings (std::numeric_limits<int>::max())) {
+            if (snapshot.name == name) {
+                return snapshot;
+            }
+        }
+        return {};
+    }
+
+    juce::SharedResourcePointer<ValueTreeAttachmentStats> stats;
+};
+
+static ValueTreeAttachmentStatsTests valueTreeAttachmentStatsTests;
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeAttachmentSyncTests.cpp
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+/**
+ Checks, that a change on either side is written exactly once and never echoed back
+ */
+class ValueTreeAttachmentSyncTests : public juce::UnitTest
+{
+public:
+    ValueTreeAttachmentSyncTests () : juce::UnitTest ("ValueTreeAttachmentSync", "ff_gui_attachments") {}
+
+    void runTest () override
+    {
+        beginTest ("Typed sync drops echoes");
+        {
+            ValueTreeAttachmentTypedSync<int> sync;
+            expect (sync.shouldUpdateComponent (1));
+            sync.componentUpdated (1);
+            expect (! sync.shouldWriteToTree (1), "the component reports the value it was updated with");
+            expect (sync.shouldWriteToTree (2));
+            expect (! sync.shouldUpdateComponent (2), "the tree reports the value that was written");
+            {
+                const ValueTreeAttachmentTypedSync<int>::ScopedUpdate scope (sync);
+                expect (! sync.shouldWriteToTree (3), "callbacks during an update are echoes");
+            }
+            expect (sync.shouldWriteToTree (3));
+        }
+
+        beginTest ("Slider change sets the property once");
+        {
+            juce::ValueTree tree ("Test");
+            juce::Slider slider;
+            slider.setRange (0.0, 1.0, 0.1);
+            ValueTreeSliderAttachment attachment (tree, "value", slider);
+
+            PropertyCounter counter (tree);
+            slider.setValue (0.3, juce::sendNotificationSync);
+            expectEquals (counter.count, 1);
+            expectWithinAbsoluteError (static_cast<double> (tree.getProperty ("value")), 0.3, 1.0e-9);
+        }
+
+        beginTest ("Tree change is not written back");
+        {
+            juce::ValueTree tree ("Test");
+            juce::Slider slider;
+            slider.setRange (0.0, 1.0, 0.1);
+            ValueTreeSliderAttachment attachment (tree, "value", slider);
+
+            PropertyCounter counter (tree);
+            tree.setProperty ("value", 0.55, nullptr);
+            // the Slider snapped the value, its delayed notification must not overwrite the tree
+            attachment.sliderValueChanged (&slider);
+            expectEquals (counter.count, 1);
+            expectWithinAbsoluteError (static_cast<double> (tree.getProperty ("value")), 0.55, 1.0e-9);
+        }
+
+        beginTest ("Button and Label write once per change");
+        {
+            juce::ValueTree tree ("Test");
+            juce::ToggleButton button;
+            juce::Label label;
+            ValueTreeButtonAttachment buttonAttachment (tree, &button, "on");
+            ValueTreeLabelAttachment labelAttachment (tree, &label, "text");
+
+            PropertyCounter counter (tree);
+            button.setToggleState (true, juce::sendNotificationSync);
+            label.setText ("hello", juce::sendNotificationSync);
+            expectEquals (counter.count, 2);
+
+            tree.setProperty ("text", "world", nullptr);
+            labelAttachment.labelTextChanged (&label);
+            expectEquals (counter.count, 3);
+            expectEquals (label.getText(), juce::String ("world"));
+        }
+    }
+
+private:
+    /** Counts the property changes of a tree */
+    struct PropertyCounter : public juce::ValueTree::Listener
+    {
+        explicit PropertyCounter (juce::ValueTree& treeToCount) : tree (treeToCount)
+        {
+            tree.addListener (this);
+        }
+
+        ~PropertyCounter () override
+        {
+            tree.removeListener (this);
+        }
+
+        void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override
+        {
+            ++count;
+        }
+
+        juce::ValueTree tree;
+        int             count = 0;
+    };
+};
+
+static ValueTreeAttachmentSyncTests valueTreeAttachmentSyncTests;
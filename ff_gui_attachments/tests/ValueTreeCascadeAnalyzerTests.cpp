@@ -0,0 +1,157 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeCascadeAnalyzerTests.cpp
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+/**
+ Checks the numbers of the ValueTreeCascadeAnalyzer for a known chain of a
+ slider driving a label, that drives a combo box
+ */
+class ValueTreeCascadeAnalyzerTests : public juce::UnitTest
+{
+public:
+    ValueTreeCascadeAnalyzerTests () : juce::UnitTest ("ValueTreeCascadeAnalyzer", "ff_gui_attachments") {}
+
+    void runTest () override
+    {
+        beginTest ("A chain of three attachments");
+        {
+            juce::ValueTree tree ("Test");
+            Chain chain (tree);
+            ValueTreeCascadeAnalyzer analyzer (tree);
+            tree.setProperty ("gain", 0.75, nullptr);
+
+            expectEquals (chain.combo.getSelectedItemIndex(), 1);
+            const auto& stats = analyzer.getStats();
+            expectEquals (stats.externalWrites, juce::int64 (1));
+            expectEquals (stats.nestedWrites, juce::int64 (2));
+            expectEquals (stats.callbacks, juce::int64 (3));
+            expectEquals (stats.maxDepth, 2);
+            expectEquals (stats.redundantUpdates, juce::int64 (0));
+            expectEquals (stats.cycles, juce::int64 (0));
+        }
+
+        beginTest ("A flickering label is flagged");
+        {
+            juce::ValueTree tree ("Test");
+            Chain chain (tree);
+            chain.flicker = true;
+            ValueTreeCascadeAnalyzer analyzer (tree);
+            tree.setProperty ("gain", 0.75, nullptr);
+
+            const auto& stats = analyzer.getStats();
+            expectEquals (stats.externalWrites, juce::int64 (1));
+            expectEquals (stats.nestedWrites, juce::int64 (6));
+            expectEquals (stats.callbacks, juce::int64 (7));
+            expectEquals (stats.maxDepth, 2);
+            expectEquals (stats.redundantUpdates, juce::int64 (2));
+            expectEquals (stats.cycles, juce::int64 (2));
+        }
+
+        beginTest ("Callbacks of other trees are not counted");
+        {
+            juce::ValueTree tree ("Test"), other ("Test");
+            Chain chain (tree), otherChain (other);
+            ValueTreeCascadeAnalyzer analyzer (tree);
+            other.setProperty ("gain", 0.75, nullptr);
+
+            expectEquals (otherChain.combo.getSelectedItemIndex(), 1);
+            expectEquals (analyzer.getStats().externalWrites, juce::int64 (0));
+            expectEquals (analyzer.getStats().callbacks, juce::int64 (0));
+            expectEquals (analyzer.getStats().maxDepth, 0);
+        }
+    }
+
+private:
+    /** Updates the slider synchronously, so the chain runs inside its callback */
+    struct SyncSliderTraits : public ValueTreeSliderTraits
+    {
+        static constexpr juce::NotificationType initialNotification = juce::dontSendNotification;
+        static constexpr juce::NotificationType updateNotification  = juce::sendNotificationSync;
+    };
+
+    /** The slider sets the label, the label selects the combo box item */
+    struct Chain : public juce::Slider::Listener,
+                   public juce::Label::Listener
+    {
+        Chain (juce::ValueTree& tree)
+          : sliderAttachment (tree, &slider, "gain"),
+            labelAttachment (tree, &label, "text"),
+            comboAttachment (tree, &combo, "mode")
+        {
+            combo.addItem ("low", 1);
+            combo.addItem ("high", 2);
+            slider.addListener (this);
+            label.addListener (this);
+        }
+
+        ~Chain () override
+        {
+            label.removeListener (this);
+            slider.removeListener (this);
+        }
+
+        void sliderValueChanged (juce::Slider*) override
+        {
+            const juce::String text = slider.getValue() > 0.5 ? "high" : "low";
+            label.setText (text, juce::sendNotificationSync);
+            if (flicker) {
+                label.setText (juce::String(), juce::sendNotificationSync);
+                label.setText (text, juce::sendNotificationSync);
+            }
+        }
+
+        void labelTextChanged (juce::Label*) override
+        {
+            combo.setSelectedItemIndex (label.getText() == "high" ? 1 : 0, juce::sendNotificationSync);
+        }
+
+        juce::Slider   slider;
+        juce::Label    label;
+        juce::ComboBox combo;
+        ValueTreeAttachment<juce::Slider, SyncSliderTraits> sliderAttachment;
+        ValueTreeLabelAttachment                            labelAttachment;
+        ValueTreeComboBoxIndexAttachment                    comboAttachment;
+        bool                                                flicker = false;
+    };
+};
+
+static ValueTreeCascadeAnalyzerTests valueTreeCascadeAnalyzerTests;
@@ -0,0 +1,208 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeDiffTests.cpp
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+/**
+ Checks, that applying a diff turns random trees into their targets, and that
+ only the children out of order are moved
+ */
+class ValueTreeDiffTests : public juce::UnitTest
+{
+public:
+    ValueTreeDiffTests () : juce::UnitTest ("ValueTreeDiff", "ff_gui_attachments") {}
+
+    void runTest () override
+    {
+        auto random = getRandom();
+
+        beginTest ("Random trees are turned into their targets");
+        {
+            for (int run=0; run < 200; ++run) {
+                const bool useKey = run % 2 == 0;
+                int nextId = 0;
+                juce::ValueTree live = createRandomTree (random, nextId, 3);
+                juce::ValueTree target = live.createCopy();
+                mutate (random, target, nextId, useKey, 3);
+
+                const juce::Identifier key = useKey ? juce::Identifier ("id") : juce::Identifier();
+                ValueTreeDiff diff (live, target, key);
+                diff.apply();
+                expect (isIdentical (live, target), "the live tree equals the target after apply");
+                expect (ValueTreeDiff (live, target, key).isEmpty(), "nothing is left to change");
+            }
+        }
+
+        beginTest ("A changed type of a value is applied");
+        {
+            juce::ValueTree live ("Preset");
+            live.setProperty ("gain", "1", nullptr);
+            juce::ValueTree target ("Preset");
+            target.setProperty ("gain", 1, nullptr);
+
+            ValueTreeDiff diff (live, target);
+            expectEquals (diff.getNumOperations(), 1);
+            diff.apply();
+            expect (live.getProperty ("gain").isInt());
+        }
+
+        beginTest ("Only the children out of order are moved");
+        {
+            expectEquals (countMoves ({ 1, 2, 3, 4, 0 }), 1);
+            expectEquals (countMoves ({ 4, 0, 1, 2, 3 }), 1);
+            expectEquals (countMoves ({ 0, 3, 1, 2, 4 }), 1);
+            expectEquals (countMoves ({ 1, 0, 3, 2, 4 }), 2);
+            expectEquals (countMoves ({ 4, 3, 2, 1, 0 }), 4);
+            expectEquals (countMoves ({ 0, 1, 2, 3, 4 }), 0);
+        }
+    }
+
+private:
+    static juce::var createRandomValue (juce::Random& random)
+    {
+        switch (random.nextInt (3)) {
+            case 0:  return random.nextInt (3);
+            case 1:  return juce::String (random.nextInt (3));
+            default: return random.nextInt (3) * 0.5;
+        }
+    }
+
+    static juce::ValueTree createRandomChild (juce::Random& random, int& nextId, int depth)
+    {
+        juce::ValueTree child = createRandomTree (random, nextId, depth);
+        // a few children have no key and are matched in their order
+        if (random.nextInt (5) > 0) {
+            child.setProperty ("id", "c" + juce::String (nextId++), nullptr);
+        }
+        return child;
+    }
+
+    static juce::ValueTree createRandomTree (juce::Random& random, int& nextId, int depth)
+    {
+        juce::ValueTree tree (random.nextBool() ? "Osc" : "Env");
+        for (int i=0; i < 4; ++i) {
+            if (random.nextBool()) {
+                tree.setProperty ("p" + juce::String (i), createRandomValue (random), nullptr);
+            }
+        }
+        const int numChildren = depth > 0 ? random.nextInt (6) : 0;
+        for (int i=0; i < numChildren; ++i) {
+            tree.addChild (createRandomChild (random, nextId, depth - 1), -1, nullptr);
+        }
+        return tree;
+    }
+
+    static void mutate (juce::Random& random, juce::ValueTree& tree, int& nextId, bool keepKeys, int depth)
+    {
+        for (int i=0; i < 4; ++i) {
+            const juce::Identifier name ("p" + juce::String (i));
+            switch (random.nextInt (4)) {
+                case 0:  tree.setProperty (name, createRandomValue (random), nullptr); break;
+                case 1:  tree.removeProperty (name, nullptr); break;
+                default: break;
+            }
+        }
+        for (int i=tree.getNumChildren() - 1; i >= 0; --i) {
+            if (random.nextInt (4) == 0) {
+                tree.removeChild (i, nullptr);
+            }
+        }
+        for (int i = depth > 0 ? random.nextInt (3) : 0; i > 0; --i) {
+            tree.addChild (createRandomChild (random, nextId, depth - 1), random.nextInt (tree.getNumChildren() + 1), nullptr);
+        }
+        for (int i=random.nextInt (3); i > 0 && tree.getNumChildren() > 1; --i) {
+            tree.moveChild (random.nextInt (tree.getNumChildren()), random.nextInt (tree.getNumChildren()), nullptr);
+        }
+        for (int i=0; i < tree.getNumChildren(); ++i) {
+            juce::ValueTree child = tree.getChild (i);
+            if (! keepKeys && random.nextInt (5) == 0) {
+                child.setProperty ("id", "c" + juce::String (nextId++), nullptr);
+            }
+            mutate (random, child, nextId, keepKeys, depth - 1);
+        }
+    }
+
+    /** Like isEquivalentTo, but the values have to be of the same type */
+    static bool isIdentical (const juce::ValueTree& a, const juce::ValueTree& b)
+    {
+        if (a.getType() != b.getType() || a.getNumProperties() != b.getNumProperties()
+            || a.getNumChildren() != b.getNumChildren()) {
+            return false;
+        }
+        for (int i=0; i < a.getNumProperties(); ++i) {
+            const juce::Identifier name = a.getPropertyName (i);
+            if (! b.hasProperty (name) || ! a.getProperty (name).equalsWithSameType (b.getProperty (name))) {
+                return false;
+            }
+        }
+        for (int i=0; i < a.getNumChildren(); ++i) {
+            if (! isIdentical (a.getChild (i), b.getChild (i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /** Returns the number of moves to reorder five keyed children into the given order */
+    int countMoves (std::initializer_list<int> order)
+    {
+        juce::ValueTree live ("Preset");
+        juce::ValueTree target ("Preset");
+        for (int i=0; i < static_cast<int> (order.size()); ++i) {
+            live.addChild (juce::ValueTree ("Osc").setProperty ("id", i, nullptr), -1, nullptr);
+        }
+        for (int i : order) {
+            target.addChild (juce::ValueTree ("Osc").setProperty ("id", i, nullptr), -1, nullptr);
+        }
+
+        ValueTreeDiff diff (live, target, "id");
+        int moves = 0;
+        for (const auto& op : diff.getOperations()) {
+            expect (op.type == ValueTreeDiff::Operation::moveChild, "matched children are only moved");
+            ++moves;
+        }
+        diff.apply();
+        expect (isIdentical (live, target));
+        return moves;
+    }
+};
+
+static ValueTreeDiffTests valueTreeDiffTests;
@@ -0,0 +1,196 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeRadioButtonGroupAttachmentTests.cpp
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+
+/**
+ Checks, that hovering and pressing the buttons doesn't write to the tree, that
+ the initial selection follows the order of the children, and that renamed
+ children are found by their new id
+ */
+class ValueTreeRadioButtonGroupAttachmentTests : public juce::UnitTest
+{
+public:
+    ValueTreeRadioButtonGroupAttachmentTests () : juce::UnitTest ("ValueTreeRadioButtonGroupAttachment", "ff_gui_attachments") {}
+
+    void runTest () override
+    {
+        beginTest ("Hover doesn't write to the tree");
+        {
+            juce::ValueTree tree ("Radio");
+            Buttons buttons;
+            ValueTreeRadioButtonGroupAttachment attachment (tree, buttons.pointers, "id", true);
+
+            PropertyCounter counter (tree);
+            for (int i=0; i < 1000; ++i) {
+                auto& button = buttons.buttons [i % numButtons];
+                button.setState (juce::Button::buttonOver);
+                button.setState (juce::Button::buttonNormal);
+            }
+            expectEquals (counter.count, 0);
+
+            buttons.buttons [1].setToggleState (true, juce::sendNotificationSync);
+            expect (isSelected (tree.getChildWithProperty ("id", "b1")));
+            const int afterFirstClick = counter.count;
+            expectGreaterThan (afterFirstClick, 0);
+
+            buttons.buttons [1].setState (juce::Button::buttonDown);
+            buttons.buttons [1].setState (juce::Button::buttonOver);
+            expectEquals (counter.count, afterFirstClick, "pressing the selected button again is no change");
+
+            buttons.buttons [2].setToggleState (true, juce::sendNotificationSync);
+            expect (isSelected (tree.getChildWithProperty ("id", "b2")));
+            expect (! isSelected (tree.getChildWithProperty ("id", "b1")));
+        }
+
+        beginTest ("Hovering a button that was on before doesn't write to the tree");
+        {
+            for (int withChildren=0; withChildren < 2; ++withChildren) {
+                juce::ValueTree tree ("Radio");
+                for (int i=0; i < numButtons * withChildren; ++i) {
+                    juce::ValueTree option ("option");
+                    option.setProperty ("id", "b" + juce::String (i), nullptr);
+                    tree.addChild (option, -1, nullptr);
+                }
+                Buttons buttons;
+                buttons.buttons [2].setToggleState (true, juce::dontSendNotification);
+                ValueTreeRadioButtonGroupAttachment attachment (tree, buttons.pointers, "id", true);
+                expect (buttons.buttons [2].getToggleState(), "the button keeps its state");
+
+                PropertyCounter counter (tree);
+                buttons.buttons [2].setState (juce::Button::buttonOver);
+                buttons.buttons [2].setState (juce::Button::buttonNormal);
+                expectEquals (counter.count, 0);
+
+                buttons.buttons [1].setToggleState (true, juce::sendNotificationSync);
+                expect (isSelected (tree.getChildWithProperty ("id", "b1")));
+                expect (! isSelected (tree.getChildWithProperty ("id", "b2")));
+            }
+        }
+
+        beginTest ("The last selected child wins");
+        {
+            juce::ValueTree tree ("Radio");
+            for (int i=0; i < numButtons; ++i) {
+                juce::ValueTree option ("option");
+                option.setProperty ("id", "b" + juce::String (i), nullptr);
+                option.setProperty (FF::propSelected, i == 0 || i == 2 ? 1 : 0, nullptr);
+                tree.addChild (option, -1, nullptr);
+            }
+            for (int run=0; run < 10; ++run) {
+                Buttons buttons;
+                ValueTreeRadioButtonGroupAttachment attachment (tree, buttons.pointers, "id", true);
+                expect (buttons.buttons [2].getToggleState());
+                expect (! buttons.buttons [0].getToggleState());
+            }
+        }
+
+        beginTest ("A renamed child is selected by its new id");
+        {
+            juce::ValueTree tree ("Radio");
+            Buttons buttons;
+            ValueTreeRadioButtonGroupAttachment attachment (tree, buttons.pointers, "id", true);
+
+            juce::ValueTree renamed = tree.getChildWithProperty ("id", "b1");
+            juce::ValueTree other   = tree.getChildWithProperty ("id", "b3");
+            other.setProperty ("id", "b9", nullptr);
+            renamed.setProperty ("id", "b3", nullptr);
+
+            buttons.buttons [3].setToggleState (true, juce::sendNotificationSync);
+            expect (isSelected (renamed));
+            expect (! isSelected (other));
+
+            buttons.buttons [0].setToggleState (true, juce::sendNotificationSync);
+            expect (! isSelected (renamed));
+            tree.removeChild (renamed, nullptr);
+            buttons.buttons [3].setToggleState (true, juce::sendNotificationSync);
+            expect (! isSelected (renamed), "a removed child isn't selected any more");
+        }
+    }
+
+private:
+    static constexpr int numButtons = 4;
+
+    struct Buttons
+    {
+        Buttons ()
+        {
+            for (int i=0; i < numButtons; ++i) {
+                buttons [i].setComponentID ("b" + juce::String (i));
+                buttons [i].setRadioGroupId (1);
+                pointers.add (&buttons [i]);
+            }
+        }
+
+        juce::ToggleButton         buttons [numButtons];
+        juce::Array<juce::Button*> pointers;
+    };
+
+    /** Counts the property changes of a tree and its children */
+    struct PropertyCounter : public juce::ValueTree::Listener
+    {
+        explicit PropertyCounter (juce::ValueTree& treeToCount) : tree (treeToCount)
+        {
+            tree.addListener (this);
+        }
+
+        ~PropertyCounter () override
+        {
+            tree.removeListener (this);
+        }
+
+        void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override
+        {
+            ++count;
+        }
+
+        juce::ValueTree tree;
+        int             count = 0;
+    };
+
+    static bool isSelected (const juce::ValueTree& child)
+    {
+        return static_cast<int> (child.getProperty (FF::propSelected)) != 0;
+    }
+};
+
+static ValueTreeRadioButtonGroupAttachmentTests valueTreeRadioButtonGroupAttachmentTests;
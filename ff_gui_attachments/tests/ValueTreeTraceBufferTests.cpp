@@ -0,0 +1,90 @@
+/*
+ ==============================================================================
+
+ Copyright (c) 2026, agent
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification,
+ are permitted provided that the following conditions are met:
+
+ 1. Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+
+ 2. Redistributions in binary form must reproduce the above copyright notice,
+ this list of conditions and the following disclaimer in the documentation
+ and/or other materials provided with the distribution.
+
+ 3. Neither the name of the copyright holder nor the names of its contributors
+ may be used to endorse or promote products derived from this software without
+ specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ==============================================================================
+ */
+
+/*
+  ==============================================================================
+
+    ValueTreeTraceBufferTests.cpp
+    Created: 17 Oct 2026
+    Author:  agent
+
+  ==============================================================================
+*/
+/**
+ Checks, that the records of a ValueTreeTraceBuffer tell the nodes apart and
+ keep the names readable
+ */
+class ValueTreeTraceBufferTests : public juce::UnitTest
+{
+public:
+    ValueTreeTraceBufferTests () : juce::UnitTest ("ValueTreeTraceBuffer", "ff_gui_attachments") {}
+
+    void runTest () override
+    {
+        beginTest ("Siblings of the same type are different nodes");
+        {
+            juce::ValueTree options ("options");
+            juce::ValueTree first ("option"), second ("option");
+            options.appendChild (first, nullptr);
+            options.appendChild (second, nullptr);
+
+            ValueTreeTraceBuffer buffer (16);
+            const juce::var value (1.0);
+            buffer.write (ValueTreeTraceBuffer::propertyChanged, first, "selected", &value);
+            buffer.write (ValueTreeTraceBuffer::propertyChanged, second, "selected", &value);
+
+            const auto records = buffer.getRecords();
+            expectEquals (static_cast<int> (records.size()), 2);
+            expect (records [0].node == &first.getProperties());
+            expect (records [1].node == &second.getProperties());
+            expect (records [0].nodeType == records [1].nodeType);
+            expectEquals (buffer.getName (records [0].nodeType), juce::String ("option"));
+            expectEquals (buffer.getName (records [1].property), juce::String ("selected"));
+        }
+
+        beginTest ("Names are kept after the Identifier is gone");
+        {
+            ValueTreeTraceBuffer buffer (16);
+            {
+                const juce::Identifier name ("traceBufferTestsTemporary");
+                buffer.write (ValueTreeTraceBuffer::propertyRemoved, juce::ValueTree ("node"), name);
+            }
+            const auto records = buffer.getRecords();
+            expectEquals (static_cast<int> (records.size()), 1);
+            expectEquals (buffer.getName (records [0].property), juce::String ("traceBufferTestsTemporary"));
+        }
+    }
+};
+
+static ValueTreeTraceBufferTests valueTreeTraceBufferTests;